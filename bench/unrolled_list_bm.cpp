@@ -0,0 +1,525 @@
+#include <unrolled_algorithm.h>
+#include <unrolled_io.h>
+#include <unrolled_list.h>
+#include <unrolled_parallel.h>
+#include <unrolled_simd.h>
+#include <unrolled_soa_list.h>
+#include <unrolled_sorted_list.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+    Бенчмарки unrolled_list<T, NodeMaxSize> для нескольких NodeMaxSize и типов элементов.
+    В качестве базовой линии используются std::list, std::deque и std::vector.
+
+    Имя бенчмарка: <операция>/<контейнер>/<количество элементов>
+*/
+
+namespace {
+
+struct Pod64 {
+    int values[16];
+};
+
+template<typename T>
+T make_value(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(24, static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        Pod64 pod{};
+        pod.values[0] = static_cast<int>(i);
+        return pod;
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+template<typename T>
+size_t weight(const T &value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        return static_cast<size_t>(value.values[0]);
+    } else {
+        return static_cast<size_t>(value);
+    }
+}
+
+template<typename Container>
+Container make_filled(size_t n) {
+    using T = typename Container::value_type;
+    Container c;
+    for (size_t i = 0; i < n; ++i) {
+        c.push_back(make_value<T>(i));
+    }
+    return c;
+}
+
+template<typename Container>
+void BM_PushBack(benchmark::State &state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+    for (auto _: state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            c.push_back(value);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_PushBackReserved(benchmark::State &state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+    for (auto _: state) {
+        Container c;
+        c.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            c.push_back(value);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_PushFront(benchmark::State &state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+    for (auto _: state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            c.push_front(value);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_PopFront(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _: state) {
+        state.PauseTiming();
+        Container c = make_filled<Container>(n);
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i) {
+            c.pop_front();
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_PopBack(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _: state) {
+        state.PauseTiming();
+        Container c = make_filled<Container>(n);
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i) {
+            c.pop_back();
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_InsertMiddle(benchmark::State &state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = make_value<T>(1);
+    for (auto _: state) {
+        state.PauseTiming();
+        Container c = make_filled<Container>(n);
+        auto it = std::next(c.begin(), n / 2);
+        state.ResumeTiming();
+        for (size_t i = 0; i < n; ++i) {
+            it = c.insert(it, value);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_EraseMiddle(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _: state) {
+        state.PauseTiming();
+        Container c = make_filled<Container>(n);
+        auto it = std::next(c.begin(), n / 2);
+        state.ResumeTiming();
+        for (size_t i = 0; i < n - n / 2; ++i) {
+            it = c.erase(it);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * (n - n / 2));
+}
+
+template<typename Container>
+void BM_Iterate(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const Container c = make_filled<Container>(n);
+    for (auto _: state) {
+        size_t sum = 0;
+        for (const auto &value: c) {
+            sum += weight(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_IterateSegments(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const Container c = make_filled<Container>(n);
+    for (auto _: state) {
+        size_t sum = unrolled::accumulate(c, size_t{0}, [](size_t acc, const auto &value) {
+            return acc + weight(value);
+        });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_RandomAccess(benchmark::State &state) {
+    const size_t n = state.range(0);
+    Container c = make_filled<Container>(n);
+    size_t pos = 0;
+    for (auto _: state) {
+        pos = (pos * 1103515245 + 12345) % n;
+        benchmark::DoNotOptimize(c[pos]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Container>
+void BM_Sort(benchmark::State &state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    Container source;
+    for (size_t i = 0; i < n; ++i) {
+        source.push_back(make_value<T>(i * 7919 % n));
+    }
+    for (auto _: state) {
+        state.PauseTiming();
+        Container c(source);
+        state.ResumeTiming();
+        c.sort([](const T &lhs, const T &rhs) { return weight(lhs) < weight(rhs); });
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_Copy(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const Container c = make_filled<Container>(n);
+    for (auto _: state) {
+        Container copy(c);
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Поиск в отсортированном контейнере: бинарный поиск по границам нод sorted_unrolled_list против std::multiset
+template<typename Container>
+void BM_SortedInsert(benchmark::State &state) {
+    const size_t n = state.range(0);
+    for (auto _: state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            c.insert(static_cast<int>(i * 7919 % n));
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename Container>
+void BM_SortedFind(benchmark::State &state) {
+    const size_t n = state.range(0);
+    Container c;
+    for (size_t i = 0; i < n; ++i) {
+        c.insert(static_cast<int>(i * 2));
+    }
+    size_t key = 0;
+    for (auto _: state) {
+        key = (key + 7919) % (2 * n);
+        benchmark::DoNotOptimize(c.find(static_cast<int>(key)));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Вставка в середину вперемешку с доступом по индексу: индекс по нодам обновляется, а не строится заново
+void BM_InsertAndLookup(benchmark::State &state) {
+    const size_t n = state.range(0);
+    auto list = make_filled<unrolled_list<int, 16> >(n);
+    size_t pos = 0;
+    for (auto _: state) {
+        pos = (pos + 7919) % list.size();
+        list.insert(list.iterator_at(pos), static_cast<int>(pos));
+        benchmark::DoNotOptimize(list[list.size() - 1 - pos]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Сумма одного поля записи из четырёх полей: нода хранит записи целиком (unrolled_list) или по колонкам (soa_unrolled_list)
+struct Order {
+    std::int32_t id;
+    std::int32_t quantity;
+    std::int32_t price;
+    std::int32_t flags;
+};
+
+void BM_FieldSumAos(benchmark::State &state) {
+    const size_t n = state.range(0);
+    unrolled_list<Order, 64> list;
+    for (size_t i = 0; i < n; ++i) {
+        list.push_back(Order{std::int32_t(i), std::int32_t(i % 100), 10, 0});
+    }
+    for (auto _: state) {
+        std::int32_t sum = 0;
+        for (auto segment: std::as_const(list).segments()) {
+            for (const Order &order: segment) {
+                sum += order.quantity;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_FieldSumSoa(benchmark::State &state) {
+    const size_t n = state.range(0);
+    unrolled::soa_unrolled_list<std::int32_t, std::int32_t, std::int32_t, std::int32_t> list;
+    for (size_t i = 0; i < n; ++i) {
+        list.emplace_back(std::int32_t(i), std::int32_t(i % 100), 10, 0);
+    }
+    for (auto _: state) {
+        std::int32_t sum = 0;
+        for (std::span<const std::int32_t> quantities: std::as_const(list).column<1>()) {
+            for (std::int32_t quantity: quantities) {
+                sum += quantity;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Запись и чтение списка через поток: блоками по ноде против поэлементного кодека
+struct Int64Codec {
+    void encode(std::ostream &os, std::int64_t value) {
+        os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    std::int64_t decode(std::istream &is) {
+        std::int64_t value = 0;
+        is.read(reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    }
+};
+
+void BM_SerializeRoundTrip(benchmark::State &state, bool codec) {
+    const auto list = make_filled<unrolled_list_auto<std::int64_t> >(state.range(0));
+    unrolled_list_auto<std::int64_t> copy;
+    for (auto _: state) {
+        std::stringstream stream;
+        if (codec) {
+            unrolled::write(stream, list, Int64Codec{});
+            unrolled::read(stream, copy, Int64Codec{});
+        } else {
+            unrolled::write(stream, list);
+            unrolled::read(stream, copy);
+        }
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(std::int64_t));
+}
+
+template<typename T>
+void BM_ParallelReduce(benchmark::State &state, unsigned threads) {
+    auto list = make_filled<unrolled_list_auto<T> >(state.range(0));
+    const unrolled::execution::parallel_policy policy{threads};
+    for (auto _: state) {
+        benchmark::DoNotOptimize(unrolled::reduce(policy, list, T()));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Сумма и поиск по unrolled_list<T, 64>: скалярный обход по нодам против unrolled::simd с выбранным набором инструкций
+template<typename T>
+void BM_SimdSum(benchmark::State &state, unrolled::simd::isa isa) {
+    const size_t n = state.range(0);
+    const auto c = make_filled<unrolled_list<T, 64>>(n);
+    unrolled::simd::use_isa(isa);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(unrolled::simd::sum(c));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename T>
+void BM_SimdFind(benchmark::State &state, unrolled::simd::isa isa) {
+    const size_t n = state.range(0);
+    const auto c = make_filled<unrolled_list<T, 64>>(n);
+    unrolled::simd::use_isa(isa);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(unrolled::simd::find(c, T(-1)));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename T>
+void BM_ScalarSum(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto c = make_filled<unrolled_list<T, 64>>(n);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(unrolled::accumulate(c, unrolled::simd::sum_t<T>(0)));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename T>
+void BM_ScalarFind(benchmark::State &state) {
+    const size_t n = state.range(0);
+    const auto c = make_filled<unrolled_list<T, 64>>(n);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(unrolled::find(c, T(-1)));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template<typename T>
+void register_simd(const std::string &type_name) {
+    constexpr int64_t kElements = 1 << 16;
+    const std::pair<unrolled::simd::isa, std::string> isas[] = {
+        {unrolled::simd::isa::scalar, "scalar"},
+        {unrolled::simd::isa::sse2, "sse2"},
+        {unrolled::simd::isa::avx2, "avx2"},
+    };
+
+    benchmark::RegisterBenchmark(("sum/accumulate/" + type_name).c_str(), BM_ScalarSum<T>)->Arg(kElements);
+    benchmark::RegisterBenchmark(("find/find/" + type_name).c_str(), BM_ScalarFind<T>)->Arg(kElements);
+    for (const auto &[isa, isa_name]: isas) {
+        if (unrolled::simd::use_isa(isa) != isa) {
+            continue;
+        }
+        benchmark::RegisterBenchmark(("sum/simd_" + isa_name + "/" + type_name).c_str(), BM_SimdSum<T>, isa)
+            ->Arg(kElements);
+        benchmark::RegisterBenchmark(("find/simd_" + isa_name + "/" + type_name).c_str(), BM_SimdFind<T>, isa)
+            ->Arg(kElements);
+    }
+}
+
+template<typename Container>
+void register_suite(const std::string &name) {
+    constexpr int64_t kElements = 1 << 16;
+
+    benchmark::RegisterBenchmark(("push_back/" + name).c_str(), BM_PushBack<Container>)->Arg(kElements);
+    if constexpr (requires(Container c) { c.reserve(0); }) {
+        benchmark::RegisterBenchmark(("push_back_reserved/" + name).c_str(), BM_PushBackReserved<Container>)
+            ->Arg(kElements);
+    }
+    if constexpr (requires(Container c) { c.push_front(c.front()); c.pop_front(); }) {
+        benchmark::RegisterBenchmark(("push_front/" + name).c_str(), BM_PushFront<Container>)->Arg(kElements);
+        benchmark::RegisterBenchmark(("pop_front/" + name).c_str(), BM_PopFront<Container>)->Arg(kElements);
+    }
+    benchmark::RegisterBenchmark(("pop_back/" + name).c_str(), BM_PopBack<Container>)->Arg(kElements);
+    benchmark::RegisterBenchmark(("insert_middle/" + name).c_str(), BM_InsertMiddle<Container>)->Arg(kElements / 16);
+    benchmark::RegisterBenchmark(("erase_middle/" + name).c_str(), BM_EraseMiddle<Container>)->Arg(kElements / 16);
+    benchmark::RegisterBenchmark(("iterate/" + name).c_str(), BM_Iterate<Container>)->Arg(kElements);
+    if constexpr (requires(Container c) { c.segments(); }) {
+        benchmark::RegisterBenchmark(("iterate_segments/" + name).c_str(), BM_IterateSegments<Container>)->Arg(kElements);
+    }
+    if constexpr (requires(Container c) { c[0]; }) {
+        benchmark::RegisterBenchmark(("random_access/" + name).c_str(), BM_RandomAccess<Container>)->Arg(kElements);
+    }
+    benchmark::RegisterBenchmark(("copy/" + name).c_str(), BM_Copy<Container>)->Arg(kElements);
+    if constexpr (requires(Container c) { c.sort(); }) {
+        benchmark::RegisterBenchmark(("sort/" + name).c_str(), BM_Sort<Container>)->Arg(kElements);
+    }
+}
+
+template<typename T>
+void register_for_type(const std::string &type_name) {
+    register_suite<unrolled_list<T, 8>>("unrolled_list<" + type_name + ",8>");
+    register_suite<unrolled_list<T, 16>>("unrolled_list<" + type_name + ",16>");
+    register_suite<unrolled_list<T, 32>>("unrolled_list<" + type_name + ",32>");
+    register_suite<unrolled_list<T, 64>>("unrolled_list<" + type_name + ",64>");
+    register_suite<unrolled_list<T, 128>>("unrolled_list<" + type_name + ",128>");
+
+    register_suite<unrolled_list_auto<T, 256>>("unrolled_list_auto<" + type_name + ",256B>");
+    register_suite<unrolled_list_auto<T, 512>>("unrolled_list_auto<" + type_name + ",512B>");
+    register_suite<unrolled_list_auto<T, 1024>>("unrolled_list_auto<" + type_name + ",1024B>");
+    register_suite<unrolled_list_auto<T, 4096>>("unrolled_list_auto<" + type_name + ",4096B>");
+
+    register_suite<std::list<T>>("std::list<" + type_name + ">");
+    register_suite<std::deque<T>>("std::deque<" + type_name + ">");
+    register_suite<std::vector<T>>("std::vector<" + type_name + ">");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    register_for_type<int>("int");
+    register_for_type<Pod64>("pod64");
+    register_for_type<std::string>("string");
+
+    for (unsigned threads: {1u, 2u, 4u, 8u}) {
+        benchmark::RegisterBenchmark(("reduce_par/" + std::to_string(threads) + "_threads").c_str(),
+                                     BM_ParallelReduce<std::int64_t>, threads)
+            ->Arg(1 << 22)
+            ->UseRealTime();
+    }
+
+    benchmark::RegisterBenchmark("sorted_insert/sorted_unrolled_list<int,64>",
+                                 BM_SortedInsert<unrolled::sorted_unrolled_list<int, 64> >)->Arg(1 << 16);
+    benchmark::RegisterBenchmark("sorted_insert/std::multiset<int>", BM_SortedInsert<std::multiset<int> >)->Arg(1 << 16);
+    benchmark::RegisterBenchmark("sorted_find/sorted_unrolled_list<int,64>",
+                                 BM_SortedFind<unrolled::sorted_unrolled_list<int, 64> >)->Arg(1 << 16);
+    benchmark::RegisterBenchmark("sorted_find/std::multiset<int>", BM_SortedFind<std::multiset<int> >)->Arg(1 << 16);
+
+    benchmark::RegisterBenchmark("insert_lookup/unrolled_list<int,16>", BM_InsertAndLookup)->Arg(1 << 21);
+
+    benchmark::RegisterBenchmark("field_sum/unrolled_list<Order,64>", BM_FieldSumAos)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("field_sum/soa_unrolled_list<int32 x4>", BM_FieldSumSoa)->Arg(1 << 20);
+
+    benchmark::RegisterBenchmark("serialize/node_blocks", BM_SerializeRoundTrip, false)->Arg(1 << 20);
+    benchmark::RegisterBenchmark("serialize/element_codec", BM_SerializeRoundTrip, true)->Arg(1 << 20);
+
+    register_simd<std::int32_t>("int32");
+    register_simd<float>("float");
+    register_simd<double>("double");
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
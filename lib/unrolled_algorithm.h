@@ -0,0 +1,185 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <span>
+
+// Algorithms over unrolled_list that process one contiguous node at a time.
+// The inner loops run over plain spans, so the compiler can vectorize them instead of
+// branching on node boundaries at every iterator increment
+namespace unrolled {
+
+template<typename It>
+concept segmented_iterator = requires(It it) {
+    it.segment();
+    { it.next_segment() } -> std::same_as<It>;
+};
+
+template<typename R>
+concept segmented_range = requires(R &r) {
+    { r.begin() } -> segmented_iterator;
+    r.end();
+};
+
+// Calls f(start, segment) for each contiguous piece of [first, last) until f returns false.
+// Returns the start of the piece f stopped at, or last
+template<segmented_iterator It, typename F>
+It visit_segments(It first, It last, F f) {
+    while (first != last) {
+        auto segment = first.segment();
+        bool final = first.node == last.node;
+        if (final)
+            segment = segment.first(last.index - first.index);
+        if (!f(first, segment))
+            return first;
+        first = final ? last : first.next_segment();
+    }
+    return last;
+}
+
+template<segmented_iterator It, typename F>
+F for_each(It first, It last, F f) {
+    unrolled::visit_segments(first, last, [&f](It, auto segment) {
+        for (auto &value: segment)
+            f(value);
+        return true;
+    });
+    return f;
+}
+
+template<segmented_iterator It, typename Predicate>
+It find_if(It first, It last, Predicate pred) {
+    It result = last;
+    unrolled::visit_segments(first, last, [&](It start, auto segment) {
+        auto found = std::find_if(segment.begin(), segment.end(), pred);
+        if (found == segment.end())
+            return true;
+        result = start;
+        result += found - segment.begin();
+        return false;
+    });
+    return result;
+}
+
+template<segmented_iterator It, typename U>
+It find(It first, It last, const U &value) {
+    return unrolled::find_if(first, last, [&value](const auto &element) { return element == value; });
+}
+
+template<segmented_iterator It, typename Predicate>
+std::ptrdiff_t count_if(It first, It last, Predicate pred) {
+    std::ptrdiff_t result = 0;
+    unrolled::visit_segments(first, last, [&](It, auto segment) {
+        for (const auto &value: segment)
+            result += pred(value) ? 1 : 0;
+        return true;
+    });
+    return result;
+}
+
+template<segmented_iterator It, typename U>
+std::ptrdiff_t count(It first, It last, const U &value) {
+    return unrolled::count_if(first, last, [&value](const auto &element) { return element == value; });
+}
+
+template<segmented_iterator It, typename Init, typename BinaryOp = std::plus<> >
+Init accumulate(It first, It last, Init init, BinaryOp op = BinaryOp()) {
+    unrolled::visit_segments(first, last, [&](It, auto segment) {
+        for (const auto &value: segment)
+            init = op(std::move(init), value);
+        return true;
+    });
+    return init;
+}
+
+template<segmented_iterator It, typename OutputIt>
+OutputIt copy(It first, It last, OutputIt out) {
+    unrolled::visit_segments(first, last, [&out](It, auto segment) {
+        out = std::copy(segment.begin(), segment.end(), out);
+        return true;
+    });
+    return out;
+}
+
+template<segmented_iterator It, typename U>
+void fill(It first, It last, const U &value) {
+    unrolled::visit_segments(first, last, [&value](It, auto segment) {
+        std::fill(segment.begin(), segment.end(), value);
+        return true;
+    });
+}
+
+// When both sequences are segmented the comparison runs over pairs of contiguous pieces
+template<segmented_iterator It1, typename It2>
+bool equal(It1 first1, It1 last1, It2 first2) {
+    return unrolled::visit_segments(first1, last1, [&first2](It1, auto segment) {
+        if constexpr (segmented_iterator<It2>) {
+            while (!segment.empty()) {
+                auto other = first2.segment();
+                size_t n = std::min(segment.size(), other.size());
+                if (!std::equal(segment.begin(), segment.begin() + n, other.begin()))
+                    return false;
+                segment = segment.subspan(n);
+                first2 += static_cast<std::ptrdiff_t>(n);
+            }
+            return true;
+        } else {
+            for (const auto &value: segment) {
+                if (!(value == *first2))
+                    return false;
+                ++first2;
+            }
+            return true;
+        }
+    }) == last1;
+}
+
+template<segmented_range R, typename F>
+F for_each(R &&r, F f) {
+    return unrolled::for_each(r.begin(), r.end(), std::move(f));
+}
+
+template<segmented_range R, typename Predicate>
+auto find_if(R &&r, Predicate pred) {
+    return unrolled::find_if(r.begin(), r.end(), std::move(pred));
+}
+
+template<segmented_range R, typename U>
+auto find(R &&r, const U &value) {
+    return unrolled::find(r.begin(), r.end(), value);
+}
+
+template<segmented_range R, typename Predicate>
+std::ptrdiff_t count_if(R &&r, Predicate pred) {
+    return unrolled::count_if(r.begin(), r.end(), std::move(pred));
+}
+
+template<segmented_range R, typename U>
+std::ptrdiff_t count(R &&r, const U &value) {
+    return unrolled::count(r.begin(), r.end(), value);
+}
+
+template<segmented_range R, typename Init, typename BinaryOp = std::plus<> >
+Init accumulate(R &&r, Init init, BinaryOp op = BinaryOp()) {
+    return unrolled::accumulate(r.begin(), r.end(), std::move(init), std::move(op));
+}
+
+template<segmented_range R, typename OutputIt>
+OutputIt copy(R &&r, OutputIt out) {
+    return unrolled::copy(r.begin(), r.end(), out);
+}
+
+template<segmented_range R, typename U>
+void fill(R &&r, const U &value) {
+    unrolled::fill(r.begin(), r.end(), value);
+}
+
+template<segmented_range R1, typename R2>
+bool equal(R1 &&r1, R2 &&r2) {
+    return std::size(r1) == std::size(r2) && unrolled::equal(r1.begin(), r1.end(), std::begin(r2));
+}
+
+} // namespace unrolled
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#if __has_include(<sys/uio.h>) && __has_include(<unistd.h>)
+#include <sys/uio.h>
+#include <unistd.h>
+#define UNROLLED_IO_HAS_FD 1
+#endif
+
+// Binary serialization of unrolled_list. A stream is a 24-byte header followed by the elements in order:
+// for trivially copyable T their object representation, written with one call per node and read straight into
+// new nodes; otherwise whatever an element codec writes. The payload does not depend on the node size, so a list
+// can be read back with another NodeMaxSize. Integers are in native byte order; reading on a host of the other
+// byte order fails. read() replaces the contents of the list and leaves it unchanged when it throws
+namespace unrolled {
+
+// encode(os, value) writes one element and decode(is) reads the next one back
+template<typename C, typename T>
+concept element_codec = requires(C &codec, std::ostream &os, std::istream &is, const T &value) {
+    codec.encode(os, value);
+    { codec.decode(is) } -> std::convertible_to<T>;
+};
+
+struct stream_header {
+    char magic[4] = {'U', 'N', 'R', 'L'};
+    std::uint16_t version = 1;
+    std::uint16_t flags = 0;
+    // sizeof(T) for raw payloads, 0 for encoded ones
+    std::uint32_t element_size = 0;
+    std::uint32_t reserved = 0;
+    std::uint64_t count = 0;
+
+    static constexpr std::uint16_t encoded = 1;
+    static constexpr std::uint16_t big_endian = 2;
+};
+
+static_assert(sizeof(stream_header) == 24);
+
+namespace detail {
+
+// Number of nodes handed to one writev/readv call
+inline constexpr size_t io_batch = 64;
+
+struct io_block {
+    void *data;
+    size_t bytes;
+};
+
+inline stream_header make_header(std::uint64_t count, std::uint32_t element_size, bool encoded) {
+    stream_header header;
+    header.flags = static_cast<std::uint16_t>((encoded ? stream_header::encoded : 0) |
+                                              (std::endian::native == std::endian::big ? stream_header::big_endian : 0));
+    header.element_size = element_size;
+    header.count = count;
+    return header;
+}
+
+inline void check_header(const stream_header &header, std::uint32_t element_size, bool encoded) {
+    const stream_header expected = make_header(0, element_size, encoded);
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+        throw std::runtime_error("unrolled::read: not an unrolled_list stream");
+    if (header.version != expected.version)
+        throw std::runtime_error("unrolled::read: unsupported version");
+    if ((header.flags & stream_header::big_endian) != (expected.flags & stream_header::big_endian))
+        throw std::runtime_error("unrolled::read: byte order mismatch");
+    if ((header.flags & stream_header::encoded) != (expected.flags & stream_header::encoded))
+        throw std::runtime_error(encoded ? "unrolled::read: stream is not encoded"
+                                         : "unrolled::read: stream is encoded, a codec is needed");
+    if (header.element_size != element_size)
+        throw std::runtime_error("unrolled::read: element size mismatch");
+}
+
+struct list_io {
+    // Replaces the contents of list with count elements that read_blocks(std::span<io_block>) reads into new nodes,
+    // io_batch nodes at a time. Nodes are allocated as the data arrives, so a corrupt count fails at the end of
+    // the data instead of allocating up front
+    template<typename List, typename ReadBlocks>
+    static void read_into_nodes(List &list, std::uint64_t count, ReadBlocks read_blocks) {
+        using Node = typename List::Node;
+        using T = typename List::value_type;
+        if (count > list.max_size())
+            throw std::length_error("unrolled::read");
+        typename List::Chain chain;
+        try {
+            io_block blocks[io_batch];
+            while (chain.size < count) {
+                Node *batch_first = nullptr;
+                size_t planned = chain.size;
+                size_t n = 0;
+                for (; n < io_batch && planned < count; ++n) {
+                    Node *node = list.create_node();
+                    list.chain_push_back(chain, node);
+                    if (!batch_first)
+                        batch_first = node;
+                    size_t k = std::min<std::uint64_t>(count - planned, List::node_capacity);
+                    blocks[n] = {node->slot_ptr(0), k * sizeof(T)};
+                    planned += k;
+                }
+                read_blocks(std::span<io_block>(blocks, n));
+                for (Node *node = batch_first; node; node = node->next) {
+                    node->size = std::min<std::uint64_t>(count - chain.size, List::node_capacity);
+                    chain.size += node->size;
+                }
+            }
+        } catch (...) {
+            list.discard_chain(chain.first);
+            throw;
+        }
+        list.clear();
+        list.link_chain(nullptr, chain);
+    }
+};
+
+} // namespace detail
+
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters>
+    requires std::is_trivially_copyable_v<T>
+void write(std::ostream &os, const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    const stream_header header = detail::make_header(list.size(), sizeof(T), false);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (auto segment: list.segments())
+        os.write(reinterpret_cast<const char *>(segment.data()), static_cast<std::streamsize>(segment.size_bytes()));
+    if (!os)
+        throw std::ios_base::failure("unrolled::write");
+}
+
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters, element_codec<T> Codec>
+void write(std::ostream &os, const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list, Codec codec) {
+    const stream_header header = detail::make_header(list.size(), 0, true);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const T &value: list)
+        codec.encode(os, value);
+    if (!os)
+        throw std::ios_base::failure("unrolled::write");
+}
+
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters>
+    requires std::is_trivially_copyable_v<T>
+void read(std::istream &is, unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    stream_header header;
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        throw std::runtime_error("unrolled::read: unexpected end of data");
+    detail::check_header(header, sizeof(T), false);
+    detail::list_io::read_into_nodes(list, header.count, [&is](std::span<detail::io_block> blocks) {
+        for (const detail::io_block &block: blocks) {
+            if (!is.read(static_cast<char *>(block.data), static_cast<std::streamsize>(block.bytes)))
+                throw std::runtime_error("unrolled::read: unexpected end of data");
+        }
+    });
+}
+
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters, element_codec<T> Codec>
+void read(std::istream &is, unrolled_list<T, NodeMaxSize, Allocator, Counters> &list, Codec codec) {
+    stream_header header;
+    if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        throw std::runtime_error("unrolled::read: unexpected end of data");
+    detail::check_header(header, 0, true);
+    unrolled_list<T, NodeMaxSize, Allocator, Counters> result(list.get_allocator());
+    for (std::uint64_t i = 0; i < header.count; ++i) {
+        T value = codec.decode(is);
+        if (!is)
+            throw std::runtime_error("unrolled::read: unexpected end of data");
+        result.push_back(std::move(value));
+    }
+    list = std::move(result);
+}
+
+#ifdef UNROLLED_IO_HAS_FD
+
+namespace detail {
+
+// Writes all blocks, resuming after partial writes; blocks are modified
+inline void write_all(int fd, iovec *blocks, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::writev(fd, blocks, static_cast<int>(n));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "unrolled::write");
+        }
+        size_t left = static_cast<size_t>(written);
+        for (; n > 0 && left >= blocks->iov_len; ++blocks, --n)
+            left -= blocks->iov_len;
+        if (n > 0) {
+            blocks->iov_base = static_cast<char *>(blocks->iov_base) + left;
+            blocks->iov_len -= left;
+        }
+    }
+}
+
+// Fills all blocks, resuming after partial reads; blocks are modified
+inline void read_all(int fd, iovec *blocks, size_t n) {
+    while (n > 0) {
+        ssize_t got = ::readv(fd, blocks, static_cast<int>(n));
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            throw std::system_error(errno, std::generic_category(), "unrolled::read");
+        }
+        if (got == 0)
+            throw std::runtime_error("unrolled::read: unexpected end of data");
+        size_t left = static_cast<size_t>(got);
+        for (; n > 0 && left >= blocks->iov_len; ++blocks, --n)
+            left -= blocks->iov_len;
+        if (n > 0) {
+            blocks->iov_base = static_cast<char *>(blocks->iov_base) + left;
+            blocks->iov_len -= left;
+        }
+    }
+}
+
+} // namespace detail
+
+// Writes the header and then io_batch nodes per writev call
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters>
+    requires std::is_trivially_copyable_v<T>
+void write(int fd, const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    stream_header header = detail::make_header(list.size(), sizeof(T), false);
+    iovec blocks[detail::io_batch + 1];
+    blocks[0] = {&header, sizeof(header)};
+    size_t n = 1;
+    for (auto segment: list.segments()) {
+        blocks[n++] = {const_cast<T *>(segment.data()), segment.size_bytes()};
+        if (n == std::size(blocks)) {
+            detail::write_all(fd, blocks, n);
+            n = 0;
+        }
+    }
+    detail::write_all(fd, blocks, n);
+}
+
+// Reads io_batch nodes per readv call
+template<typename T, size_t NodeMaxSize, typename Allocator, typename Counters>
+    requires std::is_trivially_copyable_v<T>
+void read(int fd, unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    stream_header header;
+    iovec header_block{&header, sizeof(header)};
+    detail::read_all(fd, &header_block, 1);
+    detail::check_header(header, sizeof(T), false);
+    detail::list_io::read_into_nodes(list, header.count, [fd](std::span<detail::io_block> blocks) {
+        iovec iov[detail::io_batch];
+        for (size_t i = 0; i < blocks.size(); ++i)
+            iov[i] = {blocks[i].data, blocks[i].bytes};
+        detail::read_all(fd, iov, blocks.size());
+    });
+}
+
+#endif
+
+} // namespace unrolled
@@ -1,37 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+
+// Types whose objects can be moved to another address with memcpy, leaving the source without running its destructor.
+// Specialize for types like std::unique_ptr-holding structs to let unrolled_list shift them with memmove
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {
+};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace unrolled {
+
+inline constexpr size_t cache_line_size = 64;
+
+namespace detail {
+
+inline constexpr size_t node_bytes_flag = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+} // namespace detail
+
+// Passed as NodeMaxSize, asks for nodes of at most `bytes` bytes (a multiple of cache_line_size) holding as many
+// elements as fit, aligned to a cache line
+constexpr size_t node_bytes(size_t bytes) {
+    return detail::node_bytes_flag | bytes;
+}
+
+// Snapshot of the hot-path counters of a list. elements_shifted counts every element relocated inside a node or
+// between nodes; node_walks counts the node boundaries crossed by iterators and by position lookups without the index
+struct counter_values {
+    size_t node_allocations = 0;
+    size_t node_frees = 0;
+    size_t elements_shifted = 0;
+    size_t node_walks = 0;
+    size_t peak_nodes = 0;
+};
+
+// Counters policy that compiles every hook away; the default for unrolled_list
+struct no_counters {
+    static constexpr bool enabled = false;
+
+    void node_allocated() noexcept {}
+    void node_freed() noexcept {}
+    void elements_shifted(size_t) noexcept {}
+    void node_walked() noexcept {}
+
+    counter_values values() const noexcept { return {}; }
+    void reset() noexcept {}
+};
+
+// Counters policy that records the hot-path events of one list. Iterating a const list updates them too,
+// so const access from several threads is no longer safe with this policy
+struct hot_path_counters {
+    static constexpr bool enabled = true;
+
+    void node_allocated() noexcept {
+        ++counters.node_allocations;
+        ++live_nodes;
+        counters.peak_nodes = std::max(counters.peak_nodes, live_nodes);
+    }
+
+    // Nodes may be freed by another list than the one that allocated them (after splice or swap)
+    void node_freed() noexcept {
+        ++counters.node_frees;
+        if (live_nodes > 0)
+            --live_nodes;
+    }
+
+    void elements_shifted(size_t count) noexcept { counters.elements_shifted += count; }
+    void node_walked() noexcept { ++counters.node_walks; }
+
+    counter_values values() const noexcept { return counters; }
+
+    void reset() noexcept {
+        counters = counter_values{};
+        counters.peak_nodes = live_nodes;
+    }
+
+private:
+    counter_values counters;
+    size_t live_nodes = 0;
+};
+
+template<typename T, size_t NodeMaxSize, typename Compare, typename Allocator>
+class sorted_unrolled_list;
+
+namespace detail {
+
+struct list_io;
+
+} // namespace detail
+
+} // namespace unrolled
 
-template<typename T, size_t NodeMaxSize = 10, typename Allocator = std::allocator<T> >
+template<typename T, size_t NodeMaxSize = 10, typename Allocator = std::allocator<T>,
+         typename Counters = unrolled::no_counters>
 class unrolled_list {
 private:
+    // Works on the nodes directly to keep its node directory in step with splits and merges
+    template<typename, size_t, typename, typename>
+    friend class unrolled::sorted_unrolled_list;
+    // Reads serialized elements straight into new nodes
+    friend struct unrolled::detail::list_io;
+
+    static constexpr bool sized_in_bytes = (NodeMaxSize & unrolled::detail::node_bytes_flag) != 0;
+    static constexpr size_t node_budget = NodeMaxSize & ~unrolled::detail::node_bytes_flag;
+    // next, prev, index_block, offset and size, padded to the alignment of the elements
+    static constexpr size_t node_header =
+        (3 * sizeof(void *) + 2 * sizeof(size_t) + alignof(T) - 1) / alignof(T) * alignof(T);
+    static constexpr size_t node_capacity = sized_in_bytes ? (node_budget - node_header) / sizeof(T) : NodeMaxSize;
+    static constexpr size_t node_alignment =
+        sized_in_bytes ? std::max(unrolled::cache_line_size, alignof(T)) : std::max(alignof(T), alignof(void *));
+
+    // Elements are relocated one by one when a node is split, merged or shifted. A half-done shift cannot be
+    // rolled back, so elements whose relocation may throw are copied when possible (std::move_if_noexcept) and
+    // only ever split off into new nodes, with the copies made before any source is destroyed
+    static constexpr bool nothrow_relocatable =
+        is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
+    static_assert(!sized_in_bytes || node_budget % unrolled::cache_line_size == 0,
+                  "node_bytes() expects a multiple of cache_line_size");
+    static_assert(!sized_in_bytes || (node_budget > node_header && node_capacity >= 2),
+                  "node_bytes() budget must fit the node header and at least two elements");
+
+    static constexpr size_t default_spare_limit = 2;
+
     struct Node;
+    struct IndexBlock;
     using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
     using NodeTraits = std::allocator_traits<NodeAllocator>;
 
-    struct Node {
+    // Elements of a node occupy slots [offset, offset + size), so both ends of a node can grow and shrink in O(1)
+    struct alignas(node_alignment) Node {
         Node *next = nullptr;
         Node *prev = nullptr;
+        // Block of the positional index holding the node; only meaningful while the index is valid
+        IndexBlock *index_block = nullptr;
+        size_t offset = 0;
         size_t size = 0;
-        std::aligned_storage_t<sizeof(T), alignof(T)> elements[NodeMaxSize];
+        std::aligned_storage_t<sizeof(T), alignof(T)> elements[node_capacity];
 
-        T *element_ptr(size_t i) {
+        T *slot_ptr(size_t i) {
             return reinterpret_cast<T *>(elements) + i;
         }
 
+        T *element_ptr(size_t i) {
+            return slot_ptr(offset + i);
+        }
+
         const T *element_ptr(size_t i) const {
-            return reinterpret_cast<const T *>(elements) + i;
+            return reinterpret_cast<const T *>(elements) + offset + i;
         }
     };
 
+    static_assert(!sized_in_bytes || sizeof(Node) <= node_budget);
+
+    // Positional index over the nodes, in two levels. An IndexBlock holds up to index_block_size consecutive nodes
+    // with the position of each node's first element relative to the first node of the block, and entries
+    // [index_begin, index_end) hold the blocks in order with the position of their first element. Positions are
+    // stored relative to an arbitrary origin (modulo 2^64). A mid-list insert or erase updates the starts after
+    // the node in its block and the starts of the later blocks, and a node split or merge adds or removes one
+    // block entry, so mixed updates and lookups stay far from the O(number of nodes) rebuild. Operations that
+    // move many nodes at once just drop the index, and it is rebuilt by the next indexed access
+    static constexpr size_t index_block_size = 64;
+
+    struct IndexBlock {
+        size_t count;
+        Node *nodes[index_block_size];
+        size_t starts[index_block_size];
+    };
+
+    struct IndexEntry {
+        IndexBlock *block;
+        size_t start;
+    };
+
+    using IndexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<IndexEntry>;
+    using IndexTraits = std::allocator_traits<IndexAllocator>;
+    using IndexBlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<IndexBlock>;
+    using IndexBlockTraits = std::allocator_traits<IndexBlockAllocator>;
+
     Node *head = nullptr;
     Node *tail = nullptr;
     size_t total_size = 0;
     Allocator alloc;
     NodeAllocator node_alloc;
+    IndexEntry *index_entries = nullptr;
+    size_t index_begin = 0;
+    size_t index_end = 0;
+    size_t index_capacity = 0;
+    bool index_valid = false;
+    // Emptied nodes kept for reuse, linked through next, so that a list oscillating around a node boundary
+    // does not call the allocator on every operation
+    Node *spare_head = nullptr;
+    size_t spare_count = 0;
+    size_t spare_limit = default_spare_limit;
+    // Largest capacity() asked for by reserve() since the last shrink_to_fit(); trim_spares() does not go below it
+    size_t reserved = 0;
+    // Mutable because iterating a const list counts node walks
+    [[no_unique_address]] mutable Counters counters;
+
+    // A detached run of linked nodes that is built completely before being spliced into the list
+    struct Chain {
+        Node *first = nullptr;
+        Node *last = nullptr;
+        size_t size = 0;
+    };
 
     void copy_from(const unrolled_list &other) {
-        for (const auto &element: other) {
-            push_back(element);
-        }
+        insert_chain(end(), make_chain(other.begin(), other.end()));
     }
 
 public:
@@ -66,6 +250,16 @@ public:
         reference operator*() const { return *node->element_ptr(index); }
         pointer operator->() const { return node->element_ptr(index); }
 
+        // Segmented iteration: the contiguous elements from this one to the end of its node,
+        // and the iterator to the first element of the next node
+        std::span<std::remove_reference_t<reference> > segment() const {
+            return {node->element_ptr(index), node->size - index};
+        }
+
+        Iterator next_segment() const {
+            return Iterator(node->next, 0, parent);
+        }
+
         Iterator &operator++() {
             if (!node) return *this;
             if (index + 1 < node->size) {
@@ -73,6 +267,7 @@ public:
             } else {
                 node = node->next;
                 index = 0;
+                walked();
             }
             return *this;
         }
@@ -94,6 +289,7 @@ public:
                 node = node->prev;
                 if (node)
                     index = node->size - 1;
+                walked();
             }
             return *this;
         }
@@ -104,6 +300,74 @@ public:
             return tmp;
         }
 
+        // Arithmetic skips whole nodes, so moving by n costs O(n / NodeMaxSize)
+        Iterator &operator+=(difference_type n) {
+            if (n < 0)
+                return *this -= -n;
+            size_t left = static_cast<size_t>(n);
+            while (node && left >= node->size - index) {
+                left -= node->size - index;
+                node = node->next;
+                index = 0;
+                walked();
+            }
+            index += left;
+            return *this;
+        }
+
+        Iterator &operator-=(difference_type n) {
+            if (n < 0)
+                return *this += -n;
+            if (n == 0)
+                return *this;
+            size_t left = static_cast<size_t>(n);
+            if (!node) {
+                node = parent->tail;
+                index = node->size;
+            }
+            while (left > index) {
+                left -= index;
+                node = node->prev;
+                index = node->size;
+                walked();
+            }
+            index -= left;
+            return *this;
+        }
+
+        Iterator operator+(difference_type n) const {
+            Iterator tmp = *this;
+            return tmp += n;
+        }
+
+        Iterator operator-(difference_type n) const {
+            Iterator tmp = *this;
+            return tmp -= n;
+        }
+
+        // Found by argument-dependent lookup: `using std::advance; advance(it, n);`
+        template<typename Distance>
+        friend void advance(Iterator &it, Distance n) {
+            it += static_cast<difference_type>(n);
+        }
+
+        // Sums node sizes between the iterators; last must be reachable from first
+        friend difference_type distance(Iterator first, Iterator last) {
+            if (first.node == last.node)
+                return static_cast<difference_type>(last.index) - static_cast<difference_type>(first.index);
+            size_t result = first.node->size - first.index;
+            for (Node *node = first.node->next; node != last.node; node = node->next)
+                result += node->size;
+            return static_cast<difference_type>(result + last.index);
+        }
+
+        void walked() const noexcept {
+            if constexpr (Counters::enabled) {
+                if (parent)
+                    parent->counters.node_walked();
+            }
+        }
+
         template<bool OtherConst>
         bool operator==(const Iterator<OtherConst> &other) const {
             return node == other.node && index == other.index;
@@ -120,6 +384,58 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    // Walks the list node by node, yielding each node's elements as one contiguous span
+    template<bool IsConst>
+    struct SegmentIterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::span<std::conditional_t<IsConst, const T, T> >;
+        using pointer = void;
+        using reference = value_type;
+        using difference_type = std::ptrdiff_t;
+
+        Node *node = nullptr;
+
+        value_type operator*() const { return value_type(node->element_ptr(0), node->size); }
+
+        SegmentIterator &operator++() {
+            node = node->next;
+            return *this;
+        }
+
+        SegmentIterator operator++(int) {
+            SegmentIterator tmp = *this;
+            node = node->next;
+            return tmp;
+        }
+
+        bool operator==(const SegmentIterator &other) const { return node == other.node; }
+        bool operator!=(const SegmentIterator &other) const { return node != other.node; }
+    };
+
+    template<bool IsConst>
+    struct SegmentRange {
+        Node *first = nullptr;
+
+        SegmentIterator<IsConst> begin() const { return {first}; }
+        SegmentIterator<IsConst> end() const { return {nullptr}; }
+    };
+
+    using segment_range = SegmentRange<false>;
+    using const_segment_range = SegmentRange<true>;
+
+    // Node occupancy as reported by stats(). Fill factors are size / max_node_size() of a node; an empty list
+    // reports 1, as there is nothing to compact. wasted_bytes counts the free slots of the nodes in use
+    // plus the whole spare nodes
+    struct FillStats {
+        size_t nodes = 0;
+        size_t spare_nodes = 0;
+        double average_fill = 1;
+        double min_fill = 1;
+        size_t wasted_bytes = 0;
+    };
+
+    using fill_stats = FillStats;
+
     explicit unrolled_list(const Allocator &a = Allocator())
         : alloc(a), node_alloc(a) {
     }
@@ -131,10 +447,12 @@ public:
 
     explicit unrolled_list(size_type count, const Allocator &a = Allocator())
         : alloc(a), node_alloc(a) {
-        insert(end(), count, T());
+        insert_chain(end(), make_chain(count, [this](T *dst, size_t k) {
+            construct_copies(dst, k);
+        }));
     }
 
-    template<typename InputIt>
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
     unrolled_list(InputIt first, InputIt last, const Allocator &a = Allocator())
         : alloc(a), node_alloc(a) {
         try {
@@ -150,24 +468,54 @@ public:
         insert(end(), init.begin(), init.end());
     }
 
-    unrolled_list(const unrolled_list &other, const Allocator &a = Allocator())
+    unrolled_list(const unrolled_list &other)
+        : unrolled_list(other, std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc)) {
+    }
+
+    unrolled_list(const unrolled_list &other, const Allocator &a)
         : alloc(a), node_alloc(a) {
         copy_from(other);
     }
 
-    unrolled_list(unrolled_list &&other, const Allocator &a = Allocator()) noexcept
+    unrolled_list(unrolled_list &&other) noexcept
+        : alloc(other.alloc), node_alloc(other.node_alloc) {
+        swap_contents(other);
+    }
+
+    // Takes other's nodes when a can free them, otherwise moves the elements into new nodes and clears other
+    unrolled_list(unrolled_list &&other, const Allocator &a) noexcept(
+        std::allocator_traits<Allocator>::is_always_equal::value
+    )
         : alloc(a), node_alloc(a) {
-        swap(other);
+        if (same_allocator(other)) {
+            swap_contents(other);
+        } else {
+            insert_chain(end(), make_chain(std::make_move_iterator(other.begin()),
+                                           std::make_move_iterator(other.end())));
+            other.clear();
+        }
     }
 
     ~unrolled_list() {
         clear();
+        shrink_to_fit();
+        release_index();
     }
 
     unrolled_list &operator=(const unrolled_list &other) {
         if (this != &other) {
-            unrolled_list tmp(other);
-            swap(tmp);
+            constexpr bool propagate =
+                std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value;
+            unrolled_list tmp(other, propagate ? other.alloc : alloc);
+            if constexpr (propagate) {
+                // Everything allocated with the old allocator is freed before it is replaced
+                clear();
+                shrink_to_fit();
+                release_index();
+                alloc = other.alloc;
+                node_alloc = other.node_alloc;
+            }
+            swap_contents(tmp);
         }
         return *this;
     }
@@ -177,17 +525,22 @@ public:
         std::allocator_traits<Allocator>::is_always_equal::value
     ) {
         if (this != &other) {
-            if (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
-                alloc = std::move(other.alloc);
-                node_alloc = std::move(other.node_alloc);
+            constexpr bool propagate =
+                std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value;
+            if (propagate || same_allocator(other)) {
+                // Everything allocated with the current allocator is freed before other's nodes are taken
+                clear();
+                shrink_to_fit();
+                release_index();
+                if constexpr (propagate) {
+                    alloc = other.alloc;
+                    node_alloc = other.node_alloc;
+                }
+                swap_contents(other);
+            } else {
+                assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                other.clear();
             }
-            clear();
-            head = other.head;
-            tail = other.tail;
-            total_size = other.total_size;
-            other.head = nullptr;
-            other.tail = nullptr;
-            other.total_size = 0;
         }
         return *this;
     }
@@ -198,11 +551,14 @@ public:
     //     return *this;
     // }
 
+    // Allocators are exchanged only when they propagate on swap; otherwise they must compare equal
     void swap(unrolled_list &other) noexcept {
-        using std::swap;
-        swap(head, other.head);
-        swap(tail, other.tail);
-        swap(total_size, other.total_size);
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc, other.alloc);
+            swap(node_alloc, other.node_alloc);
+        }
+        swap_contents(other);
     }
 
     friend void swap(unrolled_list &lhs, unrolled_list &rhs) noexcept {
@@ -222,13 +578,19 @@ public:
     const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
     const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
 
+    segment_range segments() noexcept { return {head}; }
+    const_segment_range segments() const noexcept { return {head}; }
+
     size_type size() const noexcept { return total_size; }
     bool empty() const noexcept { return total_size == 0; }
 
     size_type max_size() const noexcept {
-        return NodeTraits::max_size(node_alloc) * NodeMaxSize;
+        return NodeTraits::max_size(node_alloc) * node_capacity;
     }
 
+    // Number of elements a node holds; differs from NodeMaxSize when nodes are sized with node_bytes()
+    static constexpr size_type max_node_size() noexcept { return node_capacity; }
+
 
     reference front() { return *begin(); }
     const_reference front() const { return *cbegin(); }
@@ -247,37 +609,63 @@ public:
 
     allocator_type get_allocator() const { return alloc; }
 
+    reference operator[](size_type pos) {
+        return *iterator_at(pos);
+    }
+
+    const_reference operator[](size_type pos) const {
+        return *iterator_at(pos);
+    }
+
+    reference at(size_type pos) {
+        if (pos >= total_size)
+            throw std::out_of_range("unrolled_list::at");
+        return *iterator_at(pos);
+    }
+
+    const_reference at(size_type pos) const {
+        if (pos >= total_size)
+            throw std::out_of_range("unrolled_list::at");
+        return *iterator_at(pos);
+    }
+
+    // O(log(number of nodes)) while the index is valid. The const overload never builds the index
+    // (so concurrent const access stays safe) and walks the nodes from the nearer end when it is stale
+    iterator iterator_at(size_type pos) noexcept {
+        if (pos >= total_size)
+            return end();
+        if (!index_valid)
+            build_index();
+        size_t index = pos;
+        Node *node = locate(index);
+        return iterator(node, index, this);
+    }
+
+    const_iterator iterator_at(size_type pos) const noexcept {
+        if (pos >= total_size)
+            return end();
+        size_t index = pos;
+        Node *node = locate(index);
+        return const_iterator(node, index, this);
+    }
+
     void push_back(const T &value) {
-        if (tail == nullptr || tail->size == NodeMaxSize) {
-            Node *new_node = NodeTraits::allocate(node_alloc, 1);
-            NodeTraits::construct(node_alloc, new_node);
-            new_node->next = nullptr;
-            new_node->prev = tail;
-            if (tail)
-                tail->next = new_node;
-            tail = new_node;
-            if (head == nullptr)
-                head = tail;
-        }
-        T *place = tail->element_ptr(tail->size);
-        new(place) T(value);
-        ++tail->size;
-        ++total_size;
+        emplace_back(value);
     }
 
-    template <typename InputIt>
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
     void assign(InputIt first, InputIt last) {
+        Chain chain = make_chain(first, last);
         clear();
-        for (; first != last; ++first) {
-            push_back(*first);
-        }
+        insert_chain(end(), chain);
     }
 
-    void assign(size_type n, const T& t) {
+    void assign(size_type n, const T &t) {
+        Chain chain = make_chain(n, [this, &t](T *dst, size_t k) {
+            construct_copies(dst, k, t);
+        });
         clear();
-        for (size_type i = 0; i < n; ++i) {
-            push_back(t);
-        }
+        insert_chain(end(), chain);
     }
 
     void assign(std::initializer_list<T> il) {
@@ -286,86 +674,86 @@ public:
 
 
     void push_back(T &&value) {
-        if (tail == nullptr || tail->size == NodeMaxSize) {
-            Node *new_node = NodeTraits::allocate(node_alloc, 1);
-            NodeTraits::construct(node_alloc, new_node);
-            new_node->next = nullptr;
-            new_node->prev = tail;
-            if (tail)
-                tail->next = new_node;
-            tail = new_node;
-            if (head == nullptr)
-                head = tail;
-        }
-        T *place = tail->element_ptr(tail->size);
-        new(place) T(std::move(value));
-        ++tail->size;
-        ++total_size;
+        emplace_back(std::move(value));
     }
 
     void push_front(const T &value) {
-        if (head == nullptr || head->size == NodeMaxSize) {
-            Node *new_node = NodeTraits::allocate(node_alloc, 1);
-            NodeTraits::construct(node_alloc, new_node);
-            new_node->next = head;
-            new_node->prev = nullptr;
-            if (head)
-                head->prev = new_node;
-            head = new_node;
-            if (tail == nullptr)
-                tail = head;
+        emplace_front(value);
+    }
+
+    void push_front(T &&value) {
+        emplace_front(std::move(value));
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args &&... args) {
+        if (tail == nullptr || back_slots(tail) == 0) {
+            Node *new_node = create_node();
+            try {
+                construct_element(new_node->slot_ptr(0), std::forward<Args>(args)...);
+            } catch (...) {
+                destroy_node(new_node);
+                throw;
+            }
+            new_node->size = 1;
+            link_back(new_node);
+            index_push_back(new_node);
+        } else if (holds_any(tail, args...)) {
+            // An argument that is an element of the tail would be moved by open_gap() before it is read
+            T copy(std::forward<Args>(args)...);
+            return emplace_back(std::move(copy));
         } else {
-            for (size_t i = head->size; i > 0; --i) {
-                T *dest = head->element_ptr(i);
-                T *src = head->element_ptr(i - 1);
-                new(dest) T(std::move(*src));
-                src->~T();
+            open_gap(tail, tail->size);
+            try {
+                construct_element(tail->element_ptr(tail->size - 1), std::forward<Args>(args)...);
+            } catch (...) {
+                close_gap(tail, tail->size - 1);
+                throw;
             }
         }
-        new(head->element_ptr(0)) T(value);
-        ++head->size;
         ++total_size;
+        return *tail->element_ptr(tail->size - 1);
     }
 
-    void push_front(T &&value) {
-        if (head == nullptr || head->size == NodeMaxSize) {
-            Node *new_node = NodeTraits::allocate(node_alloc, 1);
-            NodeTraits::construct(node_alloc, new_node);
-            new_node->next = head;
-            new_node->prev = nullptr;
-            if (head)
-                head->prev = new_node;
-            head = new_node;
-            if (tail == nullptr)
-                tail = head;
+    template<typename... Args>
+    reference emplace_front(Args &&... args) {
+        if (head == nullptr || front_slots(head) == 0) {
+            Node *new_node = create_node();
+            try {
+                construct_element(new_node->slot_ptr(node_capacity - 1), std::forward<Args>(args)...);
+            } catch (...) {
+                destroy_node(new_node);
+                throw;
+            }
+            new_node->offset = node_capacity - 1;
+            new_node->size = 1;
+            link_front(new_node);
+            index_push_front(new_node);
+        } else if (holds_any(head, args...)) {
+            T copy(std::forward<Args>(args)...);
+            return emplace_front(std::move(copy));
         } else {
-            for (size_t i = head->size; i > 0; --i) {
-                T *dest = head->element_ptr(i);
-                T *src = head->element_ptr(i - 1);
-                new(dest) T(std::move(*src));
-                src->~T();
+            open_gap(head, 0);
+            try {
+                construct_element(head->element_ptr(0), std::forward<Args>(args)...);
+            } catch (...) {
+                close_gap(head, 0);
+                throw;
             }
+            index_move_start(head, size_t(-1));
         }
-        new(head->element_ptr(0)) T(std::move(value));
-        ++head->size;
         ++total_size;
+        return *head->element_ptr(0);
     }
 
     void pop_back() noexcept(std::is_nothrow_destructible<T>::value) {
         if (tail && tail->size > 0) {
-            size_t idx = tail->size - 1;
-            tail->element_ptr(idx)->~T();
+            tail->element_ptr(tail->size - 1)->~T();
             --tail->size;
             --total_size;
             if (tail->size == 0) {
-                Node *old = tail;
-                tail = tail->prev;
-                if (tail)
-                    tail->next = nullptr;
-                else
-                    head = nullptr;
-                NodeTraits::destroy(node_alloc, old);
-                NodeTraits::deallocate(node_alloc, old, 1);
+                index_erase(tail);
+                remove_node(tail);
             }
         }
     }
@@ -373,207 +761,422 @@ public:
     void pop_front() noexcept(std::is_nothrow_destructible<T>::value) {
         if (head && head->size > 0) {
             head->element_ptr(0)->~T();
-            size_t count = head->size - 1;
-            if (count > 0) {
-                T *buffer = new T[count];
-                try {
-                    for (size_t i = 0; i < count; ++i)
-                        buffer[i] = *head->element_ptr(i + 1);
-                } catch (...) {
-                    delete[] buffer;
-                    throw;
-                }
-                try {
-                    for (size_t i = 0; i < count; ++i) {
-                        head->element_ptr(i + 1)->~T();
-                        new(head->element_ptr(i)) T(buffer[i]);
-                    }
-                } catch (...) {
-                    for (size_t i = 0; i < count; ++i) {
-                        head->element_ptr(i)->~T();
-                        new(head->element_ptr(i + 1)) T(buffer[i]);
-                    }
-                    delete[] buffer;
-                    throw;
-                }
-                delete[] buffer;
-            }
+            ++head->offset;
             --head->size;
             --total_size;
             if (head->size == 0) {
-                Node *old = head;
-                head = head->next;
-                if (head)
-                    head->prev = nullptr;
-                else
-                    tail = nullptr;
-                NodeTraits::destroy(node_alloc, old);
-                NodeTraits::deallocate(node_alloc, old, 1);
+                index_erase(head);
+                remove_node(head);
+            } else {
+                index_move_start(head, 1);
             }
         }
     }
 
-    iterator erase(const_iterator cpos) noexcept {
-        Node *node = cpos.node;
-        if (!node) {
+    iterator erase(const_iterator cpos) noexcept(nothrow_relocatable) {
+        if (!cpos.node) {
             return end();
         }
-        size_t index = cpos.index;
-        node->element_ptr(index)->~T();
+        return erase_in_node(cpos.node, cpos.index, 1);
+    }
 
-        size_t count = node->size - index - 1;
-        if (count > 0) {
-            T buffer[NodeMaxSize];
-            for (size_t i = 0; i < count; ++i) {
-                buffer[i] = *node->element_ptr(index + 1 + i);
-            }
+    iterator erase(const_iterator first, const_iterator last) noexcept(nothrow_relocatable) {
+        size_type count = distance(first, last);
+        // Updating the index node by node would cost more than rebuilding it once
+        if (count > node_capacity)
+            index_valid = false;
+        iterator it(first.node, first.index, this);
+        while (count > 0) {
+            size_t n = std::min(count, it.node->size - it.index);
+            count -= n;
+            it = erase_in_node(it.node, it.index, n);
+        }
+        return it;
+    }
 
-            for (size_t i = 0; i < count; ++i) {
-                node->element_ptr(index + 1 + i)->~T();
-                new(node->element_ptr(index + i)) T(buffer[i]);
+    iterator insert(const_iterator pos, const T &value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T &&value) {
+        return emplace(pos, std::move(value));
+    }
+
+    iterator insert(const_iterator pos, size_type n, const T &value) {
+        return insert_chain(pos, make_chain(n, [this, &value](T *dst, size_t k) {
+            construct_copies(dst, k, value);
+        }));
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(const_iterator pos, InputIt first, InputIt last) {
+        insert_chain(pos, make_chain(first, last));
+    }
+
+    void insert(const_iterator pos, std::initializer_list<T> il) {
+        insert(pos, il.begin(), il.end());
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args &&... args) {
+        if (pos == end()) {
+            emplace_back(std::forward<Args>(args)...);
+            return iterator(tail, tail->size - 1, this);
+        }
+        return emplace_in_node(pos.node, pos.index, std::forward<Args>(args)...);
+    }
+
+    void clear() noexcept {
+        free_chain(head);
+        head = tail = nullptr;
+        total_size = 0;
+        index_valid = false;
+    }
+
+    // Maximum number of emptied nodes kept for reuse instead of being returned to the allocator
+    size_type spare_node_limit() const noexcept { return spare_limit; }
+
+    void set_spare_node_limit(size_type limit) noexcept {
+        spare_limit = limit;
+        trim_spares();
+    }
+
+    size_type spare_nodes() const noexcept { return spare_count; }
+
+    // Number of elements push_back can append without allocating: the free slots of the tail node
+    // plus the spare nodes
+    size_type capacity() const noexcept {
+        return total_size + (tail ? back_slots(tail) : 0) + spare_count * node_capacity;
+    }
+
+    // Allocates spare nodes so that capacity() is at least n. Until shrink_to_fit(), spare nodes are kept
+    // regardless of spare_node_limit() while freeing them would take capacity() below n, also by sort() and
+    // merge(); on failure capacity() is unchanged
+    void reserve(size_type n) {
+        if (n > max_size())
+            throw std::length_error("unrolled_list::reserve");
+        reserved = std::max(reserved, n);
+        size_type current = capacity();
+        if (n <= current)
+            return;
+        size_type count = (n - current + node_capacity - 1) / node_capacity;
+        Node *first = nullptr;
+        Node *last = nullptr;
+        try {
+            for (size_type i = 0; i < count; ++i) {
+                Node *node = NodeTraits::allocate(node_alloc, 1);
+                NodeTraits::construct(node_alloc, node);
+                counters.node_allocated();
+                node->next = first;
+                first = node;
+                if (!last)
+                    last = node;
+            }
+        } catch (...) {
+            while (first) {
+                Node *next = first->next;
+                release_node(first);
+                first = next;
             }
+            throw;
         }
-        --node->size;
-        --total_size;
+        last->next = spare_head;
+        spare_head = first;
+        spare_count += count;
+    }
 
-        iterator ret(node, index, this);
-        if (node->size == 0) {
-            Node *next_node = node->next;
-            if (node->prev) node->prev->next = node->next;
-            else head = node->next;
-            if (node->next) node->next->prev = node->prev;
-            else tail = node->prev;
-            free_node(node);
-            ret = iterator(next_node, 0, this);
+    // Returns all spare nodes to the allocator
+    void shrink_to_fit() noexcept {
+        reserved = 0;
+        while (spare_head)
+            release_node(pop_spare());
+    }
+
+    // Moves all elements of other in front of pos by relinking its nodes, so only the node at pos is split.
+    // When the allocators differ the elements are moved one by one instead
+    void splice(const_iterator pos, unrolled_list &other) {
+        if (&other == this || other.empty())
+            return;
+        if (!same_allocator(other)) {
+            insert(pos, std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+            return;
         }
-        return ret;
+        Node *node = split_before(pos);
+        Chain chain{other.head, other.tail, other.total_size};
+        other.head = other.tail = nullptr;
+        other.total_size = 0;
+        other.index_valid = false;
+        link_chain(node, chain);
     }
 
-    iterator erase(const_iterator first, const_iterator last) noexcept {
-        iterator it(first.node, first.index, this);
-        while (it != last) {
-            it = erase(it);
+    void splice(const_iterator pos, unrolled_list &&other) {
+        splice(pos, other);
+    }
+
+    // Moves [first, last) of other in front of pos. Interior nodes are relinked and only the elements sharing
+    // a node with first, last or pos are moved, so the cost is O(number of nodes + NodeMaxSize).
+    // other must be a different list
+    void splice(const_iterator pos, unrolled_list &other, const_iterator first, const_iterator last) {
+        if (first == last)
+            return;
+        if (!same_allocator(other)) {
+            insert(pos, std::make_move_iterator(iterator(first.node, first.index, &other)),
+                   std::make_move_iterator(iterator(last.node, last.index, &other)));
+            other.erase(first, last);
+            return;
         }
-        return it;
+        Node *node = split_before(pos);
+        link_chain(node, other.detach(first, last));
     }
 
-    iterator insert(const_iterator pos, const T &value) {
-        if (pos == end()) {
-            push_back(value);
-            iterator it = end();
-            --it;
-            return it;
+    void splice(const_iterator pos, unrolled_list &&other, const_iterator first, const_iterator last) {
+        splice(pos, other, first, last);
+    }
+
+    // Moves [pos, end()) into a new list with the same allocator
+    unrolled_list split(const_iterator pos) {
+        unrolled_list result(alloc);
+        if (pos != end())
+            result.link_chain(nullptr, detach(pos, end()));
+        return result;
+    }
+
+    // Moves all elements of other to the end of this list
+    void append(unrolled_list &&other) {
+        splice(end(), other);
+    }
+
+    // Stable merge sort. Every node is sorted in place, then runs of nodes are merged; merged elements are packed into
+    // nodes drained earlier by the merge, so only a few nodes are allocated.
+    // If comp, an allocation or a relocation throws, all elements stay in the list in an unspecified order
+    template<typename Compare = std::less<> >
+    void sort(Compare comp = Compare()) {
+        if (total_size < 2)
+            return;
+        Chain rest = detach_all();
+        // bins[i] holds up to 2^i sorted nodes that come before every element of the lower bins
+        Chain bins[sizeof(size_t) * 8];
+        size_t used = 0;
+        Chain carry;
+        Chain merged;
+        try {
+            while (rest.first) {
+                Node *node = rest.first;
+                rest.first = node->next;
+                if (rest.first)
+                    rest.first->prev = nullptr;
+                rest.size -= node->size;
+                node->next = nullptr;
+                carry = Chain{node, node, node->size};
+                std::stable_sort(node->element_ptr(0), node->element_ptr(node->size), comp);
+                size_t i = 0;
+                for (; i < used && bins[i].first; ++i) {
+                    merge_chains(bins[i], carry, merged, comp);
+                    carry = merged;
+                    merged = bins[i] = Chain{};
+                }
+                bins[i] = carry;
+                carry = Chain{};
+                used = std::max(used, i + 1);
+            }
+            for (size_t i = 0; i < used; ++i) {
+                if (bins[i].first) {
+                    merge_chains(bins[i], carry, merged, comp);
+                    carry = merged;
+                    merged = bins[i] = Chain{};
+                }
+            }
+        } catch (...) {
+            for (size_t i = used; i > 0; --i)
+                link_chain(nullptr, bins[i - 1]);
+            link_chain(nullptr, merged);
+            link_chain(nullptr, carry);
+            link_chain(nullptr, rest);
+            trim_spares();
+            throw;
         }
-        Node *node = pos.node;
-        size_t index = pos.index;
-        if (node->size <= NodeMaxSize) {
-            for (size_t j = node->size; j > index; --j) {
-                T *dest = node->element_ptr(j);
-                T *src = node->element_ptr(j - 1);
-                new(dest) T(std::move(*src));
-                src->~T();
-            }
-            new(node->element_ptr(index)) T(value);
-            ++node->size;
-            ++total_size;
-            return iterator(node, index, this);
+        link_chain(nullptr, carry);
+        restore_spares();
+    }
+
+    // Merges the sorted list other into this sorted list; equal elements of this list come first.
+    // Nodes are drained and reused as in sort(); with unequal allocators other's elements are moved into new nodes
+    // first. If comp or an allocation throws, all elements end up in this list in an unspecified order
+    template<typename Compare = std::less<> >
+    void merge(unrolled_list &other, Compare comp = Compare()) {
+        if (&other == this || other.empty())
+            return;
+        Chain b;
+        if (same_allocator(other)) {
+            b = other.detach_all();
         } else {
-            Node *new_node = NodeTraits::allocate(node_alloc, 1);
-            NodeTraits::construct(node_alloc, new_node);
-            new_node->next = node->next;
-            new_node->prev = node;
-            if (node->next)
-                node->next->prev = new_node;
-            node->next = new_node;
-            if (tail == node)
-                tail = new_node;
-            size_t mid = NodeMaxSize / 2;
-            size_t num_to_move = node->size - mid;
-            for (size_t j = 0; j < num_to_move; ++j) {
-                T *src = node->element_ptr(mid + j);
-                T *dest = new_node->element_ptr(j);
-                new(dest) T(std::move(*src));
-                src->~T();
-            }
-            new_node->size = num_to_move;
-            node->size = mid;
-            if (index <= mid) {
-                for (size_t j = node->size; j > index; --j) {
-                    T *dest = node->element_ptr(j);
-                    T *src = node->element_ptr(j - 1);
-                    new(dest) T(std::move(*src));
-                    src->~T();
+            b = make_chain(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            other.clear();
+        }
+        Chain a = detach_all();
+        Chain merged;
+        try {
+            merge_chains(a, b, merged, comp);
+        } catch (...) {
+            link_chain(nullptr, merged);
+            link_chain(nullptr, a);
+            link_chain(nullptr, b);
+            trim_spares();
+            throw;
+        }
+        link_chain(nullptr, merged);
+        restore_spares();
+    }
+
+    template<typename Compare = std::less<> >
+    void merge(unrolled_list &&other, Compare comp = Compare()) {
+        merge(other, std::move(comp));
+    }
+
+    // Removes all but the first of each run of consecutive elements for which pred(kept, element) holds,
+    // compacting each node in place and merging underfull neighbours afterwards. Returns the number removed
+    template<typename BinaryPredicate = std::equal_to<> >
+    size_type unique(BinaryPredicate pred = BinaryPredicate()) {
+        if (total_size < 2)
+            return 0;
+        size_type removed = 0;
+        if constexpr (!nothrow_relocatable) {
+            // Compacting a node in place could fail halfway for these elements, so they are erased one by one;
+            // erase() only ever moves the elements after the erased one, so kept stays valid
+            iterator kept = begin();
+            for (iterator it = std::next(kept); it != end();) {
+                if (pred(*kept, *it)) {
+                    it = erase(it);
+                    ++removed;
+                } else {
+                    kept = it++;
                 }
-                new(node->element_ptr(index)) T(value);
-                ++node->size;
-                ++total_size;
-                return iterator(node, index, this);
-            } else {
-                size_t new_index = index - mid;
-                for (size_t j = new_node->size; j > new_index; --j) {
-                    T *dest = new_node->element_ptr(j);
-                    T *src = new_node->element_ptr(j - 1);
-                    new(dest) T(std::move(*src));
-                    src->~T();
+            }
+            return removed;
+        }
+        const T *kept = nullptr;
+        for (Node *node = head; node;) {
+            size_t write = 0;
+            size_t read = 0;
+            try {
+                for (; read < node->size; ++read) {
+                    T *element = node->element_ptr(read);
+                    if (kept && pred(*kept, *element)) {
+                        element->~T();
+                        continue;
+                    }
+                    move_slots(node, node->offset + write, node->offset + read, 1);
+                    kept = node->element_ptr(write);
+                    ++write;
                 }
-                new(new_node->element_ptr(new_index)) T(value);
-                ++new_node->size;
-                ++total_size;
-                return iterator(new_node, new_index, this);
+            } catch (...) {
+                move_slots(node, node->offset + write, node->offset + read, node->size - read);
+                removed += read - write;
+                node->size -= read - write;
+                total_size -= removed;
+                index_valid = false;
+                throw;
             }
+            removed += node->size - write;
+            node->size = write;
+            Node *next = node->next;
+            if (node->size == 0)
+                remove_node(node);
+            node = next;
         }
+        total_size -= removed;
+        index_valid = false;
+        for (Node *node = head; node && node->next;) {
+            if (should_merge(node, node->next))
+                merge_with_next(node);
+            else
+                node = node->next;
+        }
+        return removed;
     }
 
-    iterator insert(const_iterator pos, size_type n, const T &value) {
-        iterator it(pos.node, pos.index, this);
-        for (size_type i = 0; i < n; ++i) {
-            it = insert(pos, value);
-            ++pos;
+    // Moves the elements into the fewest nodes, each full except the last, and returns the emptied nodes
+    // to the allocator. O(size()); invalidates all iterators
+    void compact() noexcept(nothrow_relocatable) {
+        if (!head)
+            return;
+        if constexpr (!nothrow_relocatable) {
+            // Elements that may throw when relocated are copied into new nodes, which replace the old ones
+            // only once every copy succeeded
+            Chain chain;
+            if constexpr (std::is_copy_constructible_v<T>)
+                chain = make_chain(cbegin(), cend());
+            else
+                chain = make_chain(std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            clear();
+            insert_chain(end(), chain);
+            return;
         }
-        return it;
+        Node *dst = head;
+        move_slots(dst, 0, dst->offset, dst->size);
+        dst->offset = 0;
+        for (Node *src = dst->next; src; src = dst->next) {
+            if (dst->size == node_capacity) {
+                dst = src;
+                move_slots(dst, 0, dst->offset, dst->size);
+                dst->offset = 0;
+                continue;
+            }
+            size_t n = std::min(node_capacity - dst->size, src->size);
+            transfer(dst, dst->size, src, src->offset, n);
+            dst->size += n;
+            src->offset += n;
+            src->size -= n;
+            if (src->size == 0) {
+                unlink_node(src);
+                release_node(src);
+            }
+        }
+        index_valid = false;
     }
 
-    template<typename InputIt>
-    void insert(const_iterator pos, InputIt first, InputIt last) {
-        for (; first != last; ++first) {
-            pos = insert(pos, *first);
-            ++pos;
-        }
-    }
-
-    // template<typename... Args>
-    // iterator emplace(const_iterator pos, Args&&... args) {
-    //     if (pos == end()) {
-    //         push_back(T(std::forward<Args>(args)...));
-    //         iterator it = end();
-    //         --it;
-    //         return it;
-    //     } else {
-    //         T temp(std::forward<Args>(args)...);
-    //         return insert(pos, std::move(temp));
-    //     }
-    // }
+    // Hot-path counters; all zero unless the list is instantiated with hot_path_counters
+    unrolled::counter_values counter_snapshot() const noexcept { return counters.values(); }
 
-    void clear() noexcept {
-        Node *current = head;
-        while (current) {
-            for (size_t i = 0; i < current->size; ++i) {
-                T *ptr = current->element_ptr(i);
-                ptr->~T();
-            }
-            Node *next = current->next;
-            NodeTraits::destroy(node_alloc, current);
-            NodeTraits::deallocate(node_alloc, current, 1);
-            current = next;
+    void reset_counters() noexcept { counters.reset(); }
+
+    fill_stats stats() const noexcept {
+        fill_stats result;
+        result.spare_nodes = spare_count;
+        for (const Node *node = head; node; node = node->next) {
+            ++result.nodes;
+            result.min_fill = std::min(result.min_fill, static_cast<double>(node->size) / node_capacity);
         }
-        head = tail = nullptr;
-        total_size = 0;
+        if (result.nodes > 0)
+            result.average_fill = static_cast<double>(total_size) / (result.nodes * node_capacity);
+        result.wasted_bytes = (result.nodes * node_capacity - total_size) * sizeof(T) + spare_count * sizeof(Node);
+        return result;
     }
 
     bool operator==(const unrolled_list &other) const {
         if (total_size != other.total_size)
             return false;
-        return std::equal(begin(), end(), other.begin());
+        const Node *lhs = head;
+        const Node *rhs = other.head;
+        size_t lhs_index = 0;
+        size_t rhs_index = 0;
+        while (lhs && rhs) {
+            size_t n = std::min(lhs->size - lhs_index, rhs->size - rhs_index);
+            if (!std::equal(lhs->element_ptr(lhs_index), lhs->element_ptr(lhs_index + n), rhs->element_ptr(rhs_index)))
+                return false;
+            lhs_index += n;
+            rhs_index += n;
+            if (lhs_index == lhs->size) {
+                lhs = lhs->next;
+                lhs_index = 0;
+            }
+            if (rhs_index == rhs->size) {
+                rhs = rhs->next;
+                rhs_index = 0;
+            }
+        }
+        return true;
     }
 
     bool operator!=(const unrolled_list &other) const {
@@ -581,16 +1184,1080 @@ public:
     }
 
 private:
-    void remove_node(Node *node) {
-        if (node->prev)
-            node->prev->next = node->next;
-        if (node->next)
-            node->next->prev = node->prev;
-        if (node == head)
+    // Exchanges everything but the allocators
+    void swap_contents(unrolled_list &other) noexcept {
+        using std::swap;
+        swap(head, other.head);
+        swap(tail, other.tail);
+        swap(total_size, other.total_size);
+        swap(index_entries, other.index_entries);
+        swap(index_begin, other.index_begin);
+        swap(index_end, other.index_end);
+        swap(index_capacity, other.index_capacity);
+        swap(index_valid, other.index_valid);
+        swap(spare_head, other.spare_head);
+        swap(spare_count, other.spare_count);
+        swap(spare_limit, other.spare_limit);
+        swap(reserved, other.reserved);
+    }
+
+    Node *create_node() {
+        if (spare_head) {
+            Node *node = pop_spare();
+            node->next = nullptr;
+            node->offset = 0;
+            return node;
+        }
+        Node *node = NodeTraits::allocate(node_alloc, 1);
+        NodeTraits::construct(node_alloc, node);
+        counters.node_allocated();
+        return node;
+    }
+
+    // Keeps an emptied node for reuse while there is room, otherwise frees it
+    void destroy_node(Node *node) noexcept {
+        if (spare_count < spare_limit)
+            push_spare(node);
+        else
+            release_node(node);
+    }
+
+    void push_spare(Node *node) noexcept {
+        node->next = spare_head;
+        node->prev = nullptr;
+        node->size = 0;
+        spare_head = node;
+        ++spare_count;
+    }
+
+    void trim_spares() noexcept {
+        while (spare_count > spare_limit && capacity() - node_capacity >= reserved)
+            release_node(pop_spare());
+    }
+
+    // After sort() and merge(), which pass elements through the spare nodes: the nodes they leave partly filled
+    // may have used up spares that reserve() allocated, so those are topped up again. The list is complete
+    // by then, so a failed allocation only leaves capacity() lower
+    void restore_spares() noexcept {
+        trim_spares();
+        if (capacity() < reserved) {
+            try {
+                reserve(reserved);
+            } catch (...) {
+            }
+        }
+    }
+
+    void release_node(Node *node) noexcept {
+        NodeTraits::destroy(node_alloc, node);
+        NodeTraits::deallocate(node_alloc, node, 1);
+        counters.node_freed();
+    }
+
+    Node *pop_spare() noexcept {
+        Node *node = spare_head;
+        spare_head = node->next;
+        --spare_count;
+        return node;
+    }
+
+    void link_back(Node *node) noexcept {
+        node->prev = tail;
+        if (tail)
+            tail->next = node;
+        else
+            head = node;
+        tail = node;
+    }
+
+    void link_front(Node *node) noexcept {
+        node->next = head;
+        if (head)
+            head->prev = node;
+        else
+            tail = node;
+        head = node;
+    }
+
+    // New elements are constructed through the allocator; elements that are only relocated inside the list are not
+    template<typename... Args>
+    void construct_element(T *place, Args &&... args) {
+        std::allocator_traits<Allocator>::construct(alloc, place, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void construct_copies(T *dst, size_t k, const Args &... args) {
+        size_t i = 0;
+        try {
+            for (; i < k; ++i)
+                construct_element(dst + i, args...);
+        } catch (...) {
+            std::destroy_n(dst, i);
+            throw;
+        }
+    }
+
+    void release_index() noexcept {
+        release_index_blocks();
+        if (index_entries) {
+            IndexAllocator index_alloc(alloc);
+            IndexTraits::deallocate(index_alloc, index_entries, index_capacity);
+        }
+        index_entries = nullptr;
+        index_capacity = 0;
+    }
+
+    // Blocks stay allocated while the index is invalid and are freed here, by the next rebuild or on destruction
+    void release_index_blocks() noexcept {
+        IndexBlockAllocator block_alloc(alloc);
+        for (size_t i = index_begin; i < index_end; ++i)
+            IndexBlockTraits::deallocate(block_alloc, index_entries[i].block, 1);
+        index_begin = index_end = 0;
+        index_valid = false;
+    }
+
+    IndexBlock *create_index_block() {
+        IndexBlockAllocator block_alloc(alloc);
+        IndexBlock *block = IndexBlockTraits::allocate(block_alloc, 1);
+        block->count = 0;
+        return block;
+    }
+
+    void release_index_block(IndexBlock *block) noexcept {
+        IndexBlockAllocator block_alloc(alloc);
+        IndexBlockTraits::deallocate(block_alloc, block, 1);
+    }
+
+    // Rebuilding never throws: when the index cannot be allocated it simply stays invalid
+    void build_index() noexcept {
+        release_index_blocks();
+        // Blocks start three quarters full, so node splits rarely split a block right away
+        constexpr size_t fill = index_block_size * 3 / 4;
+        size_t count = 0;
+        for (Node *node = head; node; node = node->next)
+            ++count;
+        size_t blocks = (count + fill - 1) / fill;
+        if (!grow_index_entries(blocks + blocks / 2))
+            return;
+        size_t start = 0;
+        Node *node = head;
+        while (node) {
+            IndexBlock *block;
+            try {
+                block = create_index_block();
+            } catch (...) {
+                return;
+            }
+            index_entries[index_end++] = IndexEntry{block, start};
+            size_t block_start = start;
+            for (; node && block->count < fill; node = node->next) {
+                append_to_block(block, node, start - block_start);
+                start += node->size;
+            }
+        }
+        index_valid = true;
+    }
+
+    bool grow_index_entries(size_t capacity) noexcept {
+        capacity = std::max<size_t>(capacity, 16);
+        if (capacity <= index_capacity)
+            return true;
+        IndexAllocator index_alloc(alloc);
+        IndexEntry *entries;
+        try {
+            entries = IndexTraits::allocate(index_alloc, capacity);
+        } catch (...) {
+            return false;
+        }
+        std::copy(index_entries + index_begin, index_entries + index_end, entries);
+        if (index_entries)
+            IndexTraits::deallocate(index_alloc, index_entries, index_capacity);
+        index_entries = entries;
+        index_capacity = capacity;
+        index_end -= index_begin;
+        index_begin = 0;
+        return true;
+    }
+
+    // Inserts a block entry before index_entries[at]; false if the entries could not grow
+    bool insert_index_entry(size_t at, IndexEntry entry) noexcept {
+        if (at == index_begin && index_begin > 0) {
+            index_entries[--index_begin] = entry;
+            return true;
+        }
+        if (index_end == index_capacity) {
+            if (index_begin > 0) {
+                std::copy(index_entries + index_begin, index_entries + index_end, index_entries);
+                at -= index_begin;
+                index_end -= index_begin;
+                index_begin = 0;
+            } else {
+                if (!grow_index_entries(2 * index_capacity))
+                    return false;
+            }
+        }
+        std::copy_backward(index_entries + at, index_entries + index_end, index_entries + index_end + 1);
+        index_entries[at] = entry;
+        ++index_end;
+        return true;
+    }
+
+    void erase_index_entry(IndexEntry *entry) noexcept {
+        release_index_block(entry->block);
+        if (entry == index_entries + index_begin) {
+            ++index_begin;
+        } else {
+            std::copy(entry + 1, index_entries + index_end, entry);
+            --index_end;
+        }
+    }
+
+    // Entry of a block, searched from both ends since updates cluster there
+    IndexEntry *find_index_entry(const IndexBlock *block) noexcept {
+        IndexEntry *front = index_entries + index_begin;
+        IndexEntry *back = index_entries + index_end - 1;
+        while (front->block != block && back->block != block) {
+            ++front;
+            --back;
+        }
+        return front->block == block ? front : back;
+    }
+
+    static size_t block_position(const IndexBlock *block, const Node *node) noexcept {
+        size_t front = 0;
+        size_t back = block->count - 1;
+        while (block->nodes[front] != node && block->nodes[back] != node) {
+            ++front;
+            --back;
+        }
+        return block->nodes[front] == node ? front : back;
+    }
+
+    static void append_to_block(IndexBlock *block, Node *node, size_t start) noexcept {
+        block->nodes[block->count] = node;
+        block->starts[block->count] = start;
+        ++block->count;
+        node->index_block = block;
+    }
+
+    // The size of node changed by delta (modulo 2^64) and its first element stayed in place,
+    // so the nodes after it move by delta
+    void index_grow(Node *node, size_t delta) noexcept {
+        if (!index_valid)
+            return;
+        IndexBlock *block = node->index_block;
+        for (size_t i = block->count - 1; block->nodes[i] != node; --i)
+            block->starts[i] += delta;
+        for (IndexEntry *entry = index_entries + index_end - 1; entry->block != block; --entry)
+            entry->start += delta;
+    }
+
+    // The first element of node moved by delta (modulo 2^64) while the other nodes stayed in place,
+    // as when a neighbour takes or gives one element or at push_front/pop_front
+    void index_move_start(Node *node, size_t delta) noexcept {
+        if (!index_valid)
+            return;
+        IndexBlock *block = node->index_block;
+        size_t i = block_position(block, node);
+        if (i > 0) {
+            block->starts[i] += delta;
+            return;
+        }
+        // Starts in a block are relative to its first node
+        find_index_entry(block)->start += delta;
+        for (size_t j = 1; j < block->count; ++j)
+            block->starts[j] -= delta;
+    }
+
+    // node was linked right after pos and starts where the elements of pos end: a split or a new tail
+    void index_insert_after(Node *pos, Node *node) noexcept {
+        if (!index_valid)
+            return;
+        IndexBlock *block = pos->index_block;
+        size_t i = block_position(block, pos) + 1;
+        size_t start = block->starts[i - 1] + pos->size;
+        if (block->count == index_block_size) {
+            IndexBlock *upper;
+            try {
+                upper = create_index_block();
+            } catch (...) {
+                index_valid = false;
+                return;
+            }
+            IndexEntry *entry = find_index_entry(block);
+            // A node past the end of a full block opens a new one; otherwise the block is split in half
+            size_t half = i == index_block_size ? index_block_size : index_block_size / 2;
+            size_t upper_start = half < index_block_size ? block->starts[half] : start;
+            if (!insert_index_entry(entry - index_entries + 1, IndexEntry{upper, entry->start + upper_start})) {
+                release_index_block(upper);
+                index_valid = false;
+                return;
+            }
+            for (size_t j = half; j < block->count; ++j)
+                append_to_block(upper, block->nodes[j], block->starts[j] - upper_start);
+            block->count = half;
+            if (i > half || i == index_block_size) {
+                block = upper;
+                i -= half;
+                start -= upper_start;
+            }
+        }
+        std::copy_backward(block->nodes + i, block->nodes + block->count, block->nodes + block->count + 1);
+        std::copy_backward(block->starts + i, block->starts + block->count, block->starts + block->count + 1);
+        ++block->count;
+        block->nodes[i] = node;
+        block->starts[i] = start;
+        node->index_block = block;
+    }
+
+    void index_push_back(Node *node) noexcept {
+        if (!index_valid)
+            return;
+        if (node->prev) {
+            index_insert_after(node->prev, node);
+            return;
+        }
+        IndexBlock *block;
+        try {
+            block = create_index_block();
+        } catch (...) {
+            index_valid = false;
+            return;
+        }
+        if (!insert_index_entry(index_end, IndexEntry{block, 0})) {
+            release_index_block(block);
+            index_valid = false;
+            return;
+        }
+        append_to_block(block, node, 0);
+    }
+
+    // node was linked in front of the head
+    void index_push_front(Node *node) noexcept {
+        if (!index_valid)
+            return;
+        if (!node->next) {
+            index_push_back(node);
+            return;
+        }
+        IndexEntry *first = index_entries + index_begin;
+        IndexBlock *block = first->block;
+        if (block->count == index_block_size) {
+            try {
+                block = create_index_block();
+            } catch (...) {
+                index_valid = false;
+                return;
+            }
+            if (!insert_index_entry(index_begin, IndexEntry{block, first->start - node->size})) {
+                release_index_block(block);
+                index_valid = false;
+                return;
+            }
+            append_to_block(block, node, 0);
+            return;
+        }
+        std::copy_backward(block->nodes, block->nodes + block->count, block->nodes + block->count + 1);
+        std::copy_backward(block->starts, block->starts + block->count, block->starts + block->count + 1);
+        ++block->count;
+        for (size_t j = 1; j < block->count; ++j)
+            block->starts[j] += node->size;
+        block->nodes[0] = node;
+        block->starts[0] = 0;
+        node->index_block = block;
+        first->start -= node->size;
+    }
+
+    // node is about to be unlinked. Its elements are gone or were moved to the end of the previous node,
+    // so the other nodes stay in place
+    void index_erase(Node *node) noexcept {
+        if (!index_valid)
+            return;
+        IndexBlock *block = node->index_block;
+        size_t i = block_position(block, node);
+        std::copy(block->nodes + i + 1, block->nodes + block->count, block->nodes + i);
+        std::copy(block->starts + i + 1, block->starts + block->count, block->starts + i);
+        --block->count;
+        IndexEntry *entry = find_index_entry(block);
+        if (block->count == 0) {
+            erase_index_entry(entry);
+            return;
+        }
+        if (i == 0) {
+            size_t shift = block->starts[0];
+            entry->start += shift;
+            for (size_t j = 0; j < block->count; ++j)
+                block->starts[j] -= shift;
+        }
+        // Blocks emptied by erases are merged into the next one, so the block count stays
+        // proportional to the node count
+        IndexEntry *next = entry + 1;
+        if (block->count < index_block_size / 4 && next != index_entries + index_end &&
+            block->count + next->block->count <= index_block_size * 3 / 4) {
+            IndexBlock *from = next->block;
+            size_t base = next->start - entry->start;
+            for (size_t j = 0; j < from->count; ++j)
+                append_to_block(block, from->nodes[j], base + from->starts[j]);
+            erase_index_entry(next);
+        }
+    }
+
+    // Finds the node holding position pos and turns pos into the index inside that node
+    Node *locate(size_t &pos) const noexcept {
+        if (index_valid) {
+            size_t origin = index_entries[index_begin].start;
+            const IndexEntry *entry = std::upper_bound(
+                index_entries + index_begin, index_entries + index_end, pos,
+                [origin](size_t p, const IndexEntry &e) { return p < e.start - origin; }) - 1;
+            pos -= entry->start - origin;
+            const IndexBlock *block = entry->block;
+            size_t i = std::upper_bound(block->starts, block->starts + block->count, pos) - block->starts - 1;
+            pos -= block->starts[i];
+            return block->nodes[i];
+        }
+        if (pos < total_size / 2) {
+            Node *node = head;
+            while (pos >= node->size) {
+                pos -= node->size;
+                node = node->next;
+                counters.node_walked();
+            }
+            return node;
+        }
+        Node *node = tail;
+        size_t from_end = total_size - pos;
+        while (from_end > node->size) {
+            from_end -= node->size;
+            node = node->prev;
+            counters.node_walked();
+        }
+        pos = node->size - from_end;
+        return node;
+    }
+
+    // Values that live inside a node are copied out before that node shifts its elements
+    static bool holds(Node *node, const void *value) noexcept {
+        std::less<const void *> less;
+        return !less(value, node->slot_ptr(0)) && less(value, node->slot_ptr(node_capacity));
+    }
+
+    template<typename... Args>
+    static bool holds_any(Node *node, const Args &... args) noexcept {
+        return (holds(node, std::addressof(args)) || ...);
+    }
+
+    static void destroy_elements(Node *node, size_t index, size_t count) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < count; ++i)
+                node->element_ptr(index + i)->~T();
+        }
+    }
+
+    void free_chain(Node *node) noexcept {
+        while (node) {
+            destroy_elements(node, 0, node->size);
+            Node *next = node->next;
+            destroy_node(node);
+            node = next;
+        }
+    }
+
+    // Frees the nodes of a chain whose construction failed; they go back to the allocator rather than to the
+    // spare list, so a failed insertion leaves no trace
+    void discard_chain(Node *node) noexcept {
+        while (node) {
+            destroy_elements(node, 0, node->size);
+            Node *next = node->next;
+            release_node(node);
+            node = next;
+        }
+    }
+
+    // Allocates all nodes needed for n elements up front, then lets fill(dst, k) construct k elements
+    // contiguously at the start of each node. fill must clean up after itself when it throws
+    template<typename Fill>
+    Chain make_chain(size_type n, Fill fill) {
+        Chain chain;
+        try {
+            for (size_type left = n; left > 0; left -= std::min<size_type>(left, node_capacity)) {
+                Node *node = create_node();
+                node->prev = chain.last;
+                if (chain.last)
+                    chain.last->next = node;
+                else
+                    chain.first = node;
+                chain.last = node;
+            }
+            for (Node *node = chain.first; node; node = node->next) {
+                size_t k = std::min<size_type>(n - chain.size, node_capacity);
+                fill(node->slot_ptr(0), k);
+                node->size = k;
+                chain.size += k;
+            }
+        } catch (...) {
+            discard_chain(chain.first);
+            throw;
+        }
+        return chain;
+    }
+
+    template<typename InputIt>
+    Chain make_chain(InputIt first, InputIt last) {
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+            typename std::iterator_traits<InputIt>::iterator_category>) {
+            return make_chain(static_cast<size_type>(std::distance(first, last)), [this, &first](T *dst, size_t k) {
+                first = construct_n(dst, first, k);
+            });
+        } else {
+            Chain chain;
+            try {
+                for (; first != last; ++first) {
+                    if (!chain.last || chain.last->size == node_capacity) {
+                        Node *node = create_node();
+                        node->prev = chain.last;
+                        if (chain.last)
+                            chain.last->next = node;
+                        else
+                            chain.first = node;
+                        chain.last = node;
+                    }
+                    construct_element(chain.last->slot_ptr(chain.last->size), *first);
+                    ++chain.last->size;
+                    ++chain.size;
+                }
+            } catch (...) {
+                discard_chain(chain.first);
+                throw;
+            }
+            return chain;
+        }
+    }
+
+    // Copy-constructs k elements from first into uninitialized storage and returns the advanced iterator
+    template<typename It>
+    It construct_n(T *dst, It first, size_t k) {
+        if constexpr (std::contiguous_iterator<It> && std::is_trivially_copyable_v<T> &&
+                      std::is_same_v<std::remove_cv_t<std::iter_value_t<It> >, T>) {
+            if (k > 0)
+                std::memcpy(static_cast<void *>(dst), std::to_address(first), k * sizeof(T));
+            return first + k;
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < k; ++i, ++first)
+                    construct_element(dst + i, *first);
+            } catch (...) {
+                std::destroy_n(dst, i);
+                throw;
+            }
+            return first;
+        }
+    }
+
+    // Links a chain in front of pos, splitting pos's node when pos points into its middle.
+    // Underfull nodes at both junctions are merged, and the iterator to the first inserted element is returned
+    iterator insert_chain(const_iterator pos, Chain chain) {
+        if (!chain.first)
+            return iterator(pos.node, pos.index, this);
+
+        Node *node;
+        try {
+            node = split_before(pos);
+        } catch (...) {
+            discard_chain(chain.first);
+            throw;
+        }
+        return link_chain(node, chain);
+    }
+
+    // Links a chain in front of node (at the end when it is nullptr) and merges underfull nodes at both junctions
+    iterator link_chain(Node *node, Chain chain) noexcept {
+        if (!chain.first)
+            return iterator(node, 0, this);
+        index_valid = false;
+        Node *before = node ? node->prev : tail;
+        chain.first->prev = before;
+        chain.last->next = node;
+        if (before)
+            before->next = chain.first;
+        else
+            head = chain.first;
+        if (node)
+            node->prev = chain.last;
+        else
+            tail = chain.last;
+        total_size += chain.size;
+
+        if (node && should_merge(chain.last, node))
+            merge_with_next(chain.last);
+        if (before && should_merge(before, chain.first)) {
+            size_t index = before->size;
+            merge_with_next(before);
+            return iterator(before, index, this);
+        }
+        return iterator(chain.first, 0, this);
+    }
+
+    // Returns the node that starts with the element at pos, moving the elements from pos on into a new node
+    // when pos points into the middle of its node
+    Node *split_before(const_iterator pos) {
+        if (!pos.node || pos.index == 0)
+            return pos.node;
+        Node *node = pos.node;
+        Node *suffix = create_node();
+        try {
+            transfer(suffix, 0, node, node->offset + pos.index, node->size - pos.index);
+        } catch (...) {
+            destroy_node(suffix);
+            throw;
+        }
+        suffix->size = node->size - pos.index;
+        node->size = pos.index;
+        link_after(node, suffix);
+        index_insert_after(node, suffix);
+        return suffix;
+    }
+
+    // Unlinks [first, last) as a chain of whole nodes, splitting the nodes at both ends first. The end is split
+    // before the beginning so that first stays valid when both point into the same node
+    Chain detach(const_iterator first, const_iterator last) {
+        size_t count = distance(first, last);
+        Node *after = split_before(last);
+        Node *begin = split_before(first);
+        Chain chain{begin, after ? after->prev : tail, count};
+        Node *before = begin->prev;
+        if (before)
+            before->next = after;
+        else
+            head = after;
+        if (after)
+            after->prev = before;
+        else
+            tail = before;
+        chain.first->prev = nullptr;
+        chain.last->next = nullptr;
+        total_size -= count;
+        index_valid = false;
+        if (before && after && should_merge(before, after))
+            merge_with_next(before);
+        return chain;
+    }
+
+    // Takes all nodes out of the list as a chain
+    Chain detach_all() noexcept {
+        Chain chain{head, tail, total_size};
+        head = tail = nullptr;
+        total_size = 0;
+        index_valid = false;
+        return chain;
+    }
+
+    void chain_push_back(Chain &chain, Node *node) noexcept {
+        node->prev = chain.last;
+        node->next = nullptr;
+        if (chain.last)
+            chain.last->next = node;
+        else
+            chain.first = node;
+        chain.last = node;
+    }
+
+    // Unlinks and returns the first node of a chain
+    Node *chain_pop_front(Chain &chain) noexcept {
+        Node *node = chain.first;
+        chain.first = node->next;
+        if (chain.first)
+            chain.first->prev = nullptr;
+        else
+            chain.last = nullptr;
+        node->next = nullptr;
+        return node;
+    }
+
+    // Stable merge of the sorted chains a and b into out. Elements are relocated one node span at a time into nodes
+    // appended to out, which come from the spares that drained input nodes are returned to (regardless of
+    // spare_node_limit()). a, b and out stay valid chains if comp, create_node() or a relocation throws
+    template<typename Compare>
+    void merge_chains(Chain &a, Chain &b, Chain &out, Compare &comp) {
+        if (a.first && b.first && !comp(*b.first->element_ptr(0), *a.last->element_ptr(a.last->size - 1))) {
+            chain_append(out, a);
+            chain_append(out, b);
+            return;
+        }
+        while (a.first && b.first) {
+            if (!out.last || out.last->offset + out.last->size == node_capacity)
+                chain_push_back(out, create_node());
+            Node *dst = out.last;
+            Node *an = a.first;
+            Node *bn = b.first;
+            T *ap = an->element_ptr(0);
+            T *ae = ap + an->size;
+            T *bp = bn->element_ptr(0);
+            T *be = bp + bn->size;
+            T *op = dst->element_ptr(dst->size);
+            T *oe = dst->slot_ptr(node_capacity);
+            // Commits the elements relocated so far, also when comp throws
+            auto commit = [&] {
+                size_t from_a = ap - an->element_ptr(0);
+                size_t from_b = bp - bn->element_ptr(0);
+                counters.elements_shifted(from_a + from_b);
+                an->offset += from_a;
+                an->size -= from_a;
+                a.size -= from_a;
+                bn->offset += from_b;
+                bn->size -= from_b;
+                b.size -= from_b;
+                dst->size += from_a + from_b;
+                out.size += from_a + from_b;
+                if (an->size == 0)
+                    push_spare(chain_pop_front(a));
+                if (bn->size == 0)
+                    push_spare(chain_pop_front(b));
+            };
+            try {
+                while (ap != ae && bp != be && op != oe) {
+                    T *&src = comp(*bp, *ap) ? bp : ap;
+                    relocate(op, src);
+                    ++op;
+                    ++src;
+                }
+            } catch (...) {
+                commit();
+                throw;
+            }
+            commit();
+        }
+        chain_append(out, a);
+        chain_append(out, b);
+    }
+
+    // If the copy of an element that may throw when relocated throws, src is left as it was
+    static void relocate(T *dst, T *src) noexcept(nothrow_relocatable) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::memcpy(static_cast<void *>(dst), src, sizeof(T));
+        } else {
+            new(dst) T(std::move_if_noexcept(*src));
+            src->~T();
+        }
+    }
+
+    // Relinks all nodes of from after out
+    static void chain_append(Chain &out, Chain &from) noexcept {
+        if (!from.first)
+            return;
+        from.first->prev = out.last;
+        if (out.last)
+            out.last->next = from.first;
+        else
+            out.first = from.first;
+        out.last = from.last;
+        out.size += from.size;
+        from = Chain{};
+    }
+
+    // Nodes can be moved between lists only when either list could free them
+    bool same_allocator(const unrolled_list &other) const noexcept {
+        if constexpr (NodeTraits::is_always_equal::value)
+            return true;
+        else
+            return node_alloc == other.node_alloc;
+    }
+
+    // Elements that may throw when relocated are never merged
+    static bool should_merge(const Node *left, const Node *right) noexcept {
+        return nothrow_relocatable && left->size + right->size <= node_capacity &&
+               (left->size < node_capacity / 2 || right->size < node_capacity / 2);
+    }
+
+    // Free slots past the last element and before the first one. Nodes of elements that may throw when relocated
+    // are never shifted, so they can only grow into the free slots on each side
+    static size_t back_slots(const Node *node) noexcept {
+        if constexpr (nothrow_relocatable)
+            return node_capacity - node->size;
+        else
+            return node_capacity - node->offset - node->size;
+    }
+
+    static size_t front_slots(const Node *node) noexcept {
+        if constexpr (nothrow_relocatable)
+            return node_capacity - node->size;
+        else
+            return node->offset;
+    }
+
+    // Inserts into a full node by first splitting it in half
+    template<typename... Args>
+    iterator emplace_in_node(Node *node, size_t index, Args &&... args) {
+        if constexpr (!nothrow_relocatable) {
+            if (index == 0 ? front_slots(node) == 0 : index < node->size || back_slots(node) == 0)
+                return emplace_apart(node, index, std::forward<Args>(args)...);
+        }
+        if (holds_any(node, args...)) {
+            T copy(std::forward<Args>(args)...);
+            return emplace_in_node(node, index, std::move(copy));
+        }
+        if (node->size == node_capacity) {
+            Node *new_node = create_node();
+            size_t mid = node_capacity / 2;
+            transfer(new_node, 0, node, node->offset + mid, node->size - mid);
+            new_node->size = node->size - mid;
+            node->size = mid;
+            link_after(node, new_node);
+            index_insert_after(node, new_node);
+            if (index > mid) {
+                node = new_node;
+                index -= mid;
+            }
+        }
+        open_gap(node, index);
+        try {
+            construct_element(node->element_ptr(index), std::forward<Args>(args)...);
+        } catch (...) {
+            close_gap(node, index);
+            if (node->size == 0) {
+                index_erase(node);
+                remove_node(node);
+            }
+            throw;
+        }
+        ++total_size;
+        index_grow(node, 1);
+        return iterator(node, index, this);
+    }
+
+    // Inserts an element that may throw when relocated where its node has no free slot. Instead of a shift, the
+    // elements from index on are copied into a new node behind the new element, so a throwing copy leaves the
+    // node as it was. At index 0 the element goes to the end of the previous node or into a new node before it
+    template<typename... Args>
+    iterator emplace_apart(Node *node, size_t index, Args &&... args) {
+        Node *prev = node->prev;
+        if (index == 0 && prev && back_slots(prev) > 0)
+            return emplace_in_node(prev, prev->size, std::forward<Args>(args)...);
+        Node *new_node = create_node();
+        size_t slot = index == 0 ? node_capacity - 1 : 0;
+        try {
+            construct_element(new_node->slot_ptr(slot), std::forward<Args>(args)...);
+        } catch (...) {
+            destroy_node(new_node);
+            throw;
+        }
+        if (index > 0) {
+            try {
+                transfer(new_node, 1, node, node->offset + index, node->size - index);
+            } catch (...) {
+                new_node->slot_ptr(0)->~T();
+                destroy_node(new_node);
+                throw;
+            }
+            new_node->size = node->size - index + 1;
+            node->size = index;
+            link_after(node, new_node);
+            index_insert_after(node, new_node);
+            index_grow(new_node, 1);
+        } else {
+            new_node->offset = slot;
+            new_node->size = 1;
+            if (prev) {
+                link_after(prev, new_node);
+                index_insert_after(prev, new_node);
+                index_grow(new_node, 1);
+            } else {
+                link_front(new_node);
+                index_push_front(new_node);
+            }
+        }
+        ++total_size;
+        return iterator(new_node, 0, this);
+    }
+
+    // Destroys count elements starting at position index of the node and keeps it at least half full
+    // by merging with or borrowing from a neighbour. Returns the iterator following the erased elements.
+    // Elements that may throw when relocated are not shifted, merged or borrowed: the ones after the erased
+    // elements are split off into a new node first, so a throwing copy erases nothing
+    iterator erase_in_node(Node *node, size_t index, size_t count) noexcept(nothrow_relocatable) {
+        if (!nothrow_relocatable && index > 0 && index + count < node->size)
+            split_before(const_iterator(node, index + count, this));
+        destroy_elements(node, index, count);
+        if (index < node->size - count - index) {
+            move_slots(node, node->offset + count, node->offset, index);
+            node->offset += count;
+        } else {
+            move_slots(node, node->offset + index, node->offset + index + count, node->size - count - index);
+        }
+        node->size -= count;
+        total_size -= count;
+        index_grow(node, 0 - count);
+
+        if (node->size == 0) {
+            Node *next_node = node->next;
+            index_erase(node);
+            remove_node(node);
+            return iterator(next_node, 0, this);
+        }
+
+        if (nothrow_relocatable && node->size < node_capacity / 2) {
+            if (node->next && node->size + node->next->size <= node_capacity) {
+                index_erase(node->next);
+                merge_with_next(node);
+            } else if (node->prev && node->prev->size + node->size <= node_capacity) {
+                Node *prev = node->prev;
+                index += prev->size;
+                index_erase(node);
+                merge_with_next(prev);
+                node = prev;
+            } else if (node->next) {
+                open_gap(node, node->size);
+                transfer(node, node->offset + node->size - 1, node->next, node->next->offset, 1);
+                ++node->next->offset;
+                --node->next->size;
+                index_move_start(node->next, 1);
+            } else if (node->prev) {
+                open_gap(node, 0);
+                transfer(node, node->offset, node->prev, node->prev->offset + node->prev->size - 1, 1);
+                --node->prev->size;
+                index_move_start(node, size_t(-1));
+                ++index;
+            }
+        }
+
+        if (index == node->size)
+            return iterator(node->next, 0, this);
+        return iterator(node, index, this);
+    }
+
+    void merge_with_next(Node *node) noexcept {
+        Node *next = node->next;
+        if (node->offset + node->size + next->size > node_capacity) {
+            move_slots(node, 0, node->offset, node->size);
+            node->offset = 0;
+        }
+        transfer(node, node->offset + node->size, next, next->offset, next->size);
+        node->size += next->size;
+        next->size = 0;
+        remove_node(next);
+    }
+
+    void link_after(Node *pos, Node *node) noexcept {
+        node->prev = pos;
+        node->next = pos->next;
+        if (pos->next)
+            pos->next->prev = node;
+        else
+            tail = node;
+        pos->next = node;
+    }
+
+    // Moves count elements from slot src of one node into uninitialized slots starting at dst of another.
+    // Elements that may throw when relocated are all copied before the sources are destroyed, so on an exception
+    // both nodes are left as they were
+    void transfer(Node *to, size_t dst, Node *from, size_t src, size_t count) noexcept(nothrow_relocatable) {
+        counters.elements_shifted(count);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (count > 0)
+                std::memcpy(static_cast<void *>(to->slot_ptr(dst)), from->slot_ptr(src), count * sizeof(T));
+        } else if constexpr (nothrow_relocatable) {
+            for (size_t i = 0; i < count; ++i) {
+                new(to->slot_ptr(dst + i)) T(std::move(*from->slot_ptr(src + i)));
+                from->slot_ptr(src + i)->~T();
+            }
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < count; ++i)
+                    new(to->slot_ptr(dst + i)) T(std::move_if_noexcept(*from->slot_ptr(src + i)));
+            } catch (...) {
+                while (i > 0)
+                    to->slot_ptr(dst + --i)->~T();
+                throw;
+            }
+            for (i = 0; i < count; ++i)
+                from->slot_ptr(src + i)->~T();
+        }
+    }
+
+    // Moves count elements from slot src to slot dst of the same node; the ranges may overlap.
+    // Elements that may throw when relocated only get here with count == 0 or dst == src
+    void move_slots(Node *node, size_t dst, size_t src, size_t count) noexcept {
+        if (dst != src)
+            counters.elements_shifted(count);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (count > 0 && dst != src)
+                std::memmove(static_cast<void *>(node->slot_ptr(dst)), node->slot_ptr(src), count * sizeof(T));
+        } else if (dst < src) {
+            for (size_t i = 0; i < count; ++i) {
+                new(node->slot_ptr(dst + i)) T(std::move(*node->slot_ptr(src + i)));
+                node->slot_ptr(src + i)->~T();
+            }
+        } else if (dst > src) {
+            for (size_t i = count; i > 0; --i) {
+                new(node->slot_ptr(dst + i - 1)) T(std::move(*node->slot_ptr(src + i - 1)));
+                node->slot_ptr(src + i - 1)->~T();
+            }
+        }
+    }
+
+    // Makes an uninitialized slot at position index of a non-full node, shifting the shorter side.
+    // When that side has no free slots left the node is recentered first, so pushes to either end stay amortized O(1)
+    void open_gap(Node *node, size_t index) noexcept {
+        if (index < node->size - index || (index == node->size - index && node->offset > 0)) {
+            if (node->offset == 0) {
+                size_t centered = (node_capacity - node->size + 1) / 2;
+                move_slots(node, centered, 0, node->size);
+                node->offset = centered;
+            }
+            move_slots(node, node->offset - 1, node->offset, index);
+            --node->offset;
+        } else {
+            if (node->offset + node->size == node_capacity) {
+                size_t centered = (node_capacity - node->size) / 2;
+                move_slots(node, centered, node->offset, node->size);
+                node->offset = centered;
+            }
+            move_slots(node, node->offset + index + 1, node->offset + index, node->size - index);
+        }
+        ++node->size;
+    }
+
+    // Removes the uninitialized slot at position index, shifting the shorter side
+    void close_gap(Node *node, size_t index) noexcept {
+        if (index < node->size - 1 - index) {
+            move_slots(node, node->offset + 1, node->offset, index);
+            ++node->offset;
+        } else {
+            move_slots(node, node->offset + index, node->offset + index + 1, node->size - 1 - index);
+        }
+        --node->size;
+    }
+
+    void remove_node(Node *node) noexcept {
+        unlink_node(node);
+        destroy_node(node);
+    }
+
+    void unlink_node(Node *node) noexcept {
+        if (node->prev)
+            node->prev->next = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        if (node == head)
             head = node->next;
         if (node == tail)
             tail = node->prev;
-        NodeTraits::destroy(node_alloc, node);
-        NodeTraits::deallocate(node_alloc, node, 1);
     }
 };
+
+// unrolled_list whose nodes are sized to NodeBytes bytes and aligned to a cache line,
+// whatever sizeof(T) is; see bench/ for how the default budget was chosen
+template<typename T, size_t NodeBytes = 1024, typename Allocator = std::allocator<T>,
+         typename Counters = unrolled::no_counters>
+using unrolled_list_auto = unrolled_list<T, unrolled::node_bytes(NodeBytes), Allocator, Counters>;
+
+namespace pmr {
+
+template<typename T, size_t NodeMaxSize = 10>
+using unrolled_list = ::unrolled_list<T, NodeMaxSize, std::pmr::polymorphic_allocator<T> >;
+
+template<typename T, size_t NodeBytes = 1024>
+using unrolled_list_auto = ::unrolled_list_auto<T, NodeBytes, std::pmr::polymorphic_allocator<T> >;
+
+} // namespace pmr
@@ -0,0 +1,372 @@
+#pragma once
+
+#include "unrolled_algorithm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+// Execution-policy overloads of the segmented algorithms. The node chain is cut at node boundaries into chunks of
+// roughly equal element count in one pass over the node sizes; the calling thread and helpers from a persistent pool
+// then claim chunks from a shared counter, so threads that finish early take over the remaining chunks.
+// <execution> is not used: with libstdc++ it requires linking TBB, and std::par cannot be overloaded on portably
+namespace unrolled {
+
+namespace execution {
+
+struct sequenced_policy {
+};
+
+struct parallel_policy {
+    // 0 means std::thread::hardware_concurrency()
+    unsigned threads = 0;
+    // Lists are not split into chunks smaller than this many elements
+    size_t grain = 4096;
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+} // namespace execution
+
+template<typename P>
+concept execution_policy = std::same_as<std::remove_cvref_t<P>, execution::sequenced_policy> ||
+                           std::same_as<std::remove_cvref_t<P>, execution::parallel_policy>;
+
+template<typename L>
+concept segmented_list = requires(L &l) {
+    l.segments();
+    { l.size() } -> std::convertible_to<size_t>;
+};
+
+namespace detail {
+
+template<typename SegmentIt>
+struct chunk_bound {
+    SegmentIt segment;
+    // Position of the first element of the chunk in the list
+    size_t offset;
+};
+
+// Chunk i covers the segments [bounds[i].segment, bounds[i + 1].segment)
+template<typename SegmentIt>
+struct chunk_partition {
+    std::unique_ptr<chunk_bound<SegmentIt>[]> bounds;
+    size_t chunks = 0;
+};
+
+template<typename Segments>
+auto partition_segments(Segments segments, size_t total, size_t chunks) {
+    using SegmentIt = decltype(segments.begin());
+    size_t target = std::max<size_t>(total / chunks, 1);
+    // Every chunk but the last holds at least target elements, and one more bound marks the end
+    chunk_partition<SegmentIt> partition{std::make_unique<chunk_bound<SegmentIt>[]>(total / target + 2)};
+    size_t offset = 0;
+    size_t in_chunk = 0;
+    for (auto it = segments.begin(); it != segments.end(); ++it) {
+        if (in_chunk == 0)
+            partition.bounds[partition.chunks++] = {it, offset};
+        size_t n = (*it).size();
+        offset += n;
+        in_chunk += n;
+        if (in_chunk >= target)
+            in_chunk = 0;
+    }
+    partition.bounds[partition.chunks] = {segments.end(), offset};
+    return partition;
+}
+
+inline size_t chunk_count(const execution::parallel_policy &policy, size_t total, unsigned &threads) {
+    threads = policy.threads ? policy.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    size_t by_grain = total / std::max<size_t>(policy.grain, 1);
+    // A few chunks per thread so that uneven chunks and busy cores even out
+    return std::clamp<size_t>(by_grain, 1, size_t(threads) * 4);
+}
+
+// A job offered to the pool: every helper that picks it up calls run(context). The caller owns the job and keeps it
+// alive until retract() returns
+struct pool_job {
+    void (*run)(void *);
+    void *context;
+    // Helpers inside run(); guarded by the pool mutex
+    size_t running = 0;
+};
+
+// Persistent helper threads shared by all parallel algorithms, started on first use and grown on demand, so a call
+// costs a wake-up instead of a thread start. The caller always works on its own job as well and only waits for the
+// helpers that actually joined it, so a call made while every helper is busy (for example from inside f) still
+// completes on the calling thread
+class worker_pool {
+public:
+    static worker_pool &instance() {
+        static worker_pool pool;
+        return pool;
+    }
+
+    worker_pool(const worker_pool &) = delete;
+    worker_pool &operator=(const worker_pool &) = delete;
+
+    ~worker_pool() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t t = 0; t < started; ++t)
+            workers[t].join();
+    }
+
+    // Offers job to up to `helpers` threads. If threads or memory run out, fewer helpers take part
+    void submit(pool_job &job, size_t helpers) noexcept {
+        {
+            std::lock_guard lock(mutex);
+            try {
+                grow(helpers);
+                for (size_t t = 0; t < helpers; ++t)
+                    pending.push_back(&job);
+            } catch (...) {
+            }
+        }
+        wake.notify_all();
+    }
+
+    // Withdraws the offers nobody has taken yet and waits for the helpers running job
+    void retract(pool_job &job) noexcept {
+        std::unique_lock lock(mutex);
+        std::erase(pending, &job);
+        done.wait(lock, [&] { return job.running == 0; });
+    }
+
+private:
+    worker_pool() = default;
+
+    void grow(size_t helpers) {
+        if (helpers <= started)
+            return;
+        if (helpers > capacity) {
+            auto grown = std::make_unique<std::thread[]>(helpers);
+            std::move(workers.get(), workers.get() + started, grown.get());
+            workers = std::move(grown);
+            capacity = helpers;
+        }
+        for (; started < helpers; ++started)
+            workers[started] = std::thread([this] { work(); });
+    }
+
+    void work() {
+        std::unique_lock lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&] { return stopping || !pending.empty(); });
+            if (pending.empty())
+                return;
+            pool_job *job = pending.front();
+            pending.pop_front();
+            ++job->running;
+            lock.unlock();
+            job->run(job->context);
+            lock.lock();
+            if (--job->running == 0)
+                done.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::deque<pool_job *> pending;
+    std::unique_ptr<std::thread[]> workers;
+    size_t started = 0;
+    size_t capacity = 0;
+    bool stopping = false;
+};
+
+// Calls f(i) for every chunk index on up to `threads` threads, the calling one included. The first exception
+// thrown by f stops the remaining chunks from being started and is rethrown after all threads have finished
+template<typename F>
+void run_chunks(size_t chunks, unsigned threads, F &f) {
+    size_t helpers = std::min<size_t>(threads, chunks);
+    if (helpers <= 1) {
+        // A single chunk or a single thread: no synchronisation at all
+        for (size_t i = 0; i < chunks; ++i)
+            f(i);
+        return;
+    }
+    std::atomic<size_t> next{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+                next.store(chunks, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    pool_job job{[](void *context) { (*static_cast<decltype(worker) *>(context))(); }, &worker};
+    worker_pool &pool = worker_pool::instance();
+    pool.submit(job, helpers - 1);
+    worker();
+    pool.retract(job);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// Calls chunk(segment_first, segment_last, offset) for each chunk of list
+template<typename List, typename Chunk>
+void parallel_chunks(const execution::parallel_policy &policy, List &list, Chunk chunk) {
+    unsigned threads;
+    size_t chunks = chunk_count(policy, list.size(), threads);
+    auto partition = partition_segments(list.segments(), list.size(), chunks);
+    auto f = [&](size_t i) {
+        chunk(partition.bounds[i].segment, partition.bounds[i + 1].segment, partition.bounds[i].offset);
+    };
+    run_chunks(partition.chunks, threads, f);
+}
+
+} // namespace detail
+
+// f may be called concurrently from several threads
+template<execution_policy Policy, segmented_list List, typename F>
+void for_each(Policy &&policy, List &&list, F f) {
+    if constexpr (std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>) {
+        unrolled::for_each(list.begin(), list.end(), std::move(f));
+    } else {
+        detail::parallel_chunks(policy, list, [&f](auto first, auto last, size_t) {
+            for (; first != last; ++first) {
+                for (auto &value: *first)
+                    f(value);
+            }
+        });
+    }
+}
+
+// Writes op(e) for every element e to out, which must allow advancing by n (random-access iterators, or
+// unrolled_list iterators, which skip whole nodes). Returns the end of the output
+template<execution_policy Policy, segmented_list List, typename OutputIt, typename UnaryOp>
+OutputIt transform(Policy &&policy, List &&list, OutputIt out, UnaryOp op) {
+    if constexpr (std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>) {
+        unrolled::visit_segments(list.begin(), list.end(), [&](auto, auto segment) {
+            out = std::transform(segment.begin(), segment.end(), out, op);
+            return true;
+        });
+        return out;
+    } else {
+        using difference_type = typename std::iterator_traits<OutputIt>::difference_type;
+        detail::parallel_chunks(policy, list, [&op, out](auto first, auto last, size_t offset) {
+            OutputIt it = out;
+            it += static_cast<difference_type>(offset);
+            for (; first != last; ++first)
+                it = std::transform((*first).begin(), (*first).end(), it, op);
+        });
+        out += static_cast<difference_type>(list.size());
+        return out;
+    }
+}
+
+// op must be associative and commutative, as for std::reduce
+template<execution_policy Policy, segmented_list List, typename Init, typename BinaryOp = std::plus<> >
+Init reduce(Policy &&policy, List &&list, Init init, BinaryOp op = BinaryOp()) {
+    if constexpr (std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>) {
+        return unrolled::accumulate(list.begin(), list.end(), std::move(init), std::move(op));
+    } else {
+        unsigned threads;
+        size_t chunks = detail::chunk_count(policy, list.size(), threads);
+        auto partition = detail::partition_segments(list.segments(), list.size(), chunks);
+        // One slot per chunk, so the workers need no lock and the partials are combined in list order
+        auto partials = std::make_unique<std::optional<Init>[]>(partition.chunks);
+        auto f = [&](size_t i) {
+            std::optional<Init> partial;
+            for (auto first = partition.bounds[i].segment; first != partition.bounds[i + 1].segment; ++first) {
+                for (const auto &value: *first)
+                    partial = partial ? op(std::move(*partial), value) : Init(value);
+            }
+            partials[i] = std::move(partial);
+        };
+        detail::run_chunks(partition.chunks, threads, f);
+        for (size_t i = 0; i < partition.chunks; ++i) {
+            if (partials[i])
+                init = op(std::move(init), std::move(*partials[i]));
+        }
+        return init;
+    }
+}
+
+template<execution_policy Policy, segmented_list List, typename Predicate>
+std::ptrdiff_t count_if(Policy &&policy, List &&list, Predicate pred) {
+    if constexpr (std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>) {
+        return unrolled::count_if(list.begin(), list.end(), std::move(pred));
+    } else {
+        std::atomic<std::ptrdiff_t> result{0};
+        detail::parallel_chunks(policy, list, [&](auto first, auto last, size_t) {
+            std::ptrdiff_t count = 0;
+            for (; first != last; ++first) {
+                for (const auto &value: *first)
+                    count += pred(value) ? 1 : 0;
+            }
+            result.fetch_add(count, std::memory_order_relaxed);
+        });
+        return result.load();
+    }
+}
+
+// Sorts about equal chunks of the list, cut at node boundaries, on separate threads with list.sort(), then merges
+// neighbouring sorted chunks pairwise in parallel rounds. Stable. If comp throws, all elements stay in the list
+// in an unspecified order
+template<execution_policy Policy, segmented_list List, typename Compare = std::less<> >
+void sort(Policy &&policy, List &list, Compare comp = Compare()) {
+    if constexpr (std::same_as<std::remove_cvref_t<Policy>, execution::sequenced_policy>) {
+        list.sort(std::move(comp));
+    } else {
+        unsigned threads;
+        size_t chunks = detail::chunk_count(policy, list.size(), threads);
+        if (chunks < 2 || threads < 2) {
+            list.sort(std::move(comp));
+            return;
+        }
+        auto partition = detail::partition_segments(list.segments(), list.size(), chunks);
+        const size_t count = partition.chunks;
+        // Runs are move-constructed from the list, so they keep its allocator
+        auto runs = std::make_unique<std::optional<List>[]>(count);
+        try {
+            // Cut from the back so that the offsets of the earlier chunks stay valid; every cut is at a node boundary
+            for (size_t i = count - 1; i > 0; --i)
+                runs[i].emplace(list.split(list.iterator_at(partition.bounds[i].offset)));
+            runs[0].emplace(std::move(list));
+
+            auto sort_run = [&](size_t i) {
+                runs[i]->sort(comp);
+            };
+            detail::run_chunks(count, threads, sort_run);
+            for (size_t width = 1; width < count; width *= 2) {
+                auto merge_pair = [&](size_t pair) {
+                    size_t i = pair * 2 * width;
+                    runs[i]->merge(*runs[i + width], comp);
+                };
+                detail::run_chunks((count + width - 1) / (2 * width), threads, merge_pair);
+            }
+        } catch (...) {
+            for (size_t i = 0; i < count; ++i) {
+                if (runs[i])
+                    list.append(std::move(*runs[i]));
+            }
+            throw;
+        }
+        list = std::move(*runs[0]);
+    }
+}
+
+} // namespace unrolled
@@ -0,0 +1,485 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UNROLLED_SIMD_X86 1
+#endif
+
+// Explicitly vectorized scans over the elements array of every node of unrolled_list<int32_t/float/double>.
+// Each kernel exists in a scalar, an SSE2 and an AVX2 build; the widest one supported by the CPU is picked
+// at run time. With NaNs in float/double data the results of min/max are unspecified
+namespace unrolled::simd {
+
+template<typename T>
+concept element = std::same_as<T, std::int32_t> || std::same_as<T, float> || std::same_as<T, double>;
+
+// Integers are summed in 64 bits so that sums over large lists do not overflow
+template<typename T>
+using sum_t = std::conditional_t<std::is_integral_v<T>, std::int64_t, T>;
+
+enum class compare {
+    equal,
+    not_equal,
+    less,
+    greater,
+};
+
+enum class isa {
+    scalar,
+    sse2,
+    avx2,
+};
+
+namespace detail {
+
+namespace scalar {
+
+template<typename T>
+struct vec {
+    using reg = T;
+    using acc = sum_t<T>;
+    static constexpr size_t lanes = 1;
+
+    static reg load(const T *p) { return *p; }
+    static reg set1(T v) { return v; }
+    static unsigned eq(reg a, reg b) { return a == b; }
+    static unsigned lt(reg a, reg b) { return a < b; }
+    static unsigned gt(reg a, reg b) { return a > b; }
+    static reg min(reg a, reg b) { return b < a ? b : a; }
+    static reg max(reg a, reg b) { return a < b ? b : a; }
+    static T hmin(reg a) { return a; }
+    static T hmax(reg a) { return a; }
+    static acc zero() { return 0; }
+    static acc add(acc s, reg v) { return s + v; }
+    static sum_t<T> hsum(acc s) { return s; }
+};
+
+#include "unrolled_simd_kernels.h"
+
+} // namespace scalar
+
+// Horizontal reductions go through memory; they run once per node, not per element
+template<typename T>
+T reduce_min(const T *values, size_t n) {
+    T result = values[0];
+    for (size_t i = 1; i < n; ++i)
+        result = values[i] < result ? values[i] : result;
+    return result;
+}
+
+template<typename T>
+T reduce_max(const T *values, size_t n) {
+    T result = values[0];
+    for (size_t i = 1; i < n; ++i)
+        result = result < values[i] ? values[i] : result;
+    return result;
+}
+
+template<typename T>
+T reduce_sum(const T *values, size_t n) {
+    T result = 0;
+    for (size_t i = 0; i < n; ++i)
+        result += values[i];
+    return result;
+}
+
+#ifdef UNROLLED_SIMD_X86
+
+namespace sse2 {
+
+template<typename T>
+struct vec;
+
+template<>
+struct vec<std::int32_t> {
+    using reg = __m128i;
+    using acc = __m128i;
+    static constexpr size_t lanes = 4;
+
+    static reg load(const std::int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static reg set1(std::int32_t v) { return _mm_set1_epi32(v); }
+    static unsigned mask(reg m) { return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+    static unsigned eq(reg a, reg b) { return mask(_mm_cmpeq_epi32(a, b)); }
+    static unsigned lt(reg a, reg b) { return mask(_mm_cmplt_epi32(a, b)); }
+    static unsigned gt(reg a, reg b) { return mask(_mm_cmpgt_epi32(a, b)); }
+
+    static reg select(reg m, reg a, reg b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+    static reg min(reg a, reg b) { return select(_mm_cmplt_epi32(a, b), a, b); }
+    static reg max(reg a, reg b) { return select(_mm_cmpgt_epi32(a, b), a, b); }
+
+    static void store(std::int32_t *p, reg r) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), r); }
+    static std::int32_t hmin(reg r) {
+        std::int32_t values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static std::int32_t hmax(reg r) {
+        std::int32_t values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    // Two 64-bit lanes; every 32-bit value is sign-extended before it is added
+    static acc zero() { return _mm_setzero_si128(); }
+
+    static acc add(acc s, reg v) {
+        reg sign = _mm_srai_epi32(v, 31);
+        s = _mm_add_epi64(s, _mm_unpacklo_epi32(v, sign));
+        return _mm_add_epi64(s, _mm_unpackhi_epi32(v, sign));
+    }
+
+    static void store_acc(std::int64_t *p, acc r) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), r); }
+    static std::int64_t hsum(acc s) {
+        std::int64_t values[2];
+        store_acc(values, s);
+        return reduce_sum(values, 2);
+    }
+};
+
+template<>
+struct vec<float> {
+    using reg = __m128;
+    using acc = __m128;
+    static constexpr size_t lanes = 4;
+
+    static reg load(const float *p) { return _mm_loadu_ps(p); }
+    static reg set1(float v) { return _mm_set1_ps(v); }
+    static unsigned eq(reg a, reg b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+    static unsigned lt(reg a, reg b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+    static unsigned gt(reg a, reg b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+    static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+    static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+    static void store(float *p, reg r) { _mm_storeu_ps(p, r); }
+    static float hmin(reg r) {
+        float values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static float hmax(reg r) {
+        float values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    static acc zero() { return _mm_setzero_ps(); }
+    static acc add(acc s, reg v) { return _mm_add_ps(s, v); }
+    static float hsum(acc s) {
+        float values[lanes];
+        store(values, s);
+        return reduce_sum(values, lanes);
+    }
+};
+
+template<>
+struct vec<double> {
+    using reg = __m128d;
+    using acc = __m128d;
+    static constexpr size_t lanes = 2;
+
+    static reg load(const double *p) { return _mm_loadu_pd(p); }
+    static reg set1(double v) { return _mm_set1_pd(v); }
+    static unsigned eq(reg a, reg b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+    static unsigned lt(reg a, reg b) { return _mm_movemask_pd(_mm_cmplt_pd(a, b)); }
+    static unsigned gt(reg a, reg b) { return _mm_movemask_pd(_mm_cmpgt_pd(a, b)); }
+    static reg min(reg a, reg b) { return _mm_min_pd(a, b); }
+    static reg max(reg a, reg b) { return _mm_max_pd(a, b); }
+    static void store(double *p, reg r) { _mm_storeu_pd(p, r); }
+    static double hmin(reg r) {
+        double values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static double hmax(reg r) {
+        double values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    static acc zero() { return _mm_setzero_pd(); }
+    static acc add(acc s, reg v) { return _mm_add_pd(s, v); }
+    static double hsum(acc s) {
+        double values[lanes];
+        store(values, s);
+        return reduce_sum(values, lanes);
+    }
+};
+
+#include "unrolled_simd_kernels.h"
+
+} // namespace sse2
+
+// Everything up to the matching pop, templates included, is compiled for AVX2 and only called after a CPU check.
+// clang defines __GNUC__ but ignores #pragma GCC target, so it gets the target attribute on every function instead
+#if defined(__clang__)
+#define UNROLLED_SIMD_AVX2 1
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#define UNROLLED_SIMD_AVX2 1
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#if defined(UNROLLED_SIMD_AVX2)
+namespace avx2 {
+
+template<typename T>
+struct vec;
+
+template<>
+struct vec<std::int32_t> {
+    using reg = __m256i;
+    using acc = __m256i;
+    static constexpr size_t lanes = 8;
+
+    static reg load(const std::int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static reg set1(std::int32_t v) { return _mm256_set1_epi32(v); }
+    static unsigned mask(reg m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+    static unsigned eq(reg a, reg b) { return mask(_mm256_cmpeq_epi32(a, b)); }
+    static unsigned lt(reg a, reg b) { return mask(_mm256_cmpgt_epi32(b, a)); }
+    static unsigned gt(reg a, reg b) { return mask(_mm256_cmpgt_epi32(a, b)); }
+    static reg min(reg a, reg b) { return _mm256_min_epi32(a, b); }
+    static reg max(reg a, reg b) { return _mm256_max_epi32(a, b); }
+    static void store(std::int32_t *p, reg r) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), r); }
+    static std::int32_t hmin(reg r) {
+        std::int32_t values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static std::int32_t hmax(reg r) {
+        std::int32_t values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    // Four 64-bit lanes; both halves of the register are sign-extended before they are added
+    static acc zero() { return _mm256_setzero_si256(); }
+
+    static acc add(acc s, reg v) {
+        s = _mm256_add_epi64(s, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        return _mm256_add_epi64(s, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+
+    static void store_acc(std::int64_t *p, acc r) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), r); }
+    static std::int64_t hsum(acc s) {
+        std::int64_t values[4];
+        store_acc(values, s);
+        return reduce_sum(values, 4);
+    }
+};
+
+template<>
+struct vec<float> {
+    using reg = __m256;
+    using acc = __m256;
+    static constexpr size_t lanes = 8;
+
+    static reg load(const float *p) { return _mm256_loadu_ps(p); }
+    static reg set1(float v) { return _mm256_set1_ps(v); }
+    static unsigned eq(reg a, reg b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+    static unsigned lt(reg a, reg b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+    static unsigned gt(reg a, reg b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+    static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+    static void store(float *p, reg r) { _mm256_storeu_ps(p, r); }
+    static float hmin(reg r) {
+        float values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static float hmax(reg r) {
+        float values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    static acc zero() { return _mm256_setzero_ps(); }
+    static acc add(acc s, reg v) { return _mm256_add_ps(s, v); }
+    static float hsum(acc s) {
+        float values[lanes];
+        store(values, s);
+        return reduce_sum(values, lanes);
+    }
+};
+
+template<>
+struct vec<double> {
+    using reg = __m256d;
+    using acc = __m256d;
+    static constexpr size_t lanes = 4;
+
+    static reg load(const double *p) { return _mm256_loadu_pd(p); }
+    static reg set1(double v) { return _mm256_set1_pd(v); }
+    static unsigned eq(reg a, reg b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+    static unsigned lt(reg a, reg b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+    static unsigned gt(reg a, reg b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+    static reg min(reg a, reg b) { return _mm256_min_pd(a, b); }
+    static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+    static void store(double *p, reg r) { _mm256_storeu_pd(p, r); }
+    static double hmin(reg r) {
+        double values[lanes];
+        store(values, r);
+        return reduce_min(values, lanes);
+    }
+
+    static double hmax(reg r) {
+        double values[lanes];
+        store(values, r);
+        return reduce_max(values, lanes);
+    }
+
+    static acc zero() { return _mm256_setzero_pd(); }
+    static acc add(acc s, reg v) { return _mm256_add_pd(s, v); }
+    static double hsum(acc s) {
+        double values[lanes];
+        store(values, s);
+        return reduce_sum(values, lanes);
+    }
+};
+
+#include "unrolled_simd_kernels.h"
+
+} // namespace avx2
+#endif // UNROLLED_SIMD_AVX2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // UNROLLED_SIMD_X86
+
+inline isa detect_isa() noexcept {
+#if defined(UNROLLED_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        return isa::avx2;
+#endif
+#if defined(UNROLLED_SIMD_X86)
+    return isa::sse2;
+#else
+    return isa::scalar;
+#endif
+}
+
+inline isa &selected_isa() noexcept {
+    static isa value = detect_isa();
+    return value;
+}
+
+// Runs f with the kernel set of the selected instruction set
+template<typename F>
+decltype(auto) dispatch(F &&f) {
+    switch (selected_isa()) {
+#if defined(UNROLLED_SIMD_AVX2)
+        case isa::avx2:
+            return f(avx2::kernels{});
+#endif
+#if defined(UNROLLED_SIMD_X86)
+        case isa::sse2:
+            return f(sse2::kernels{});
+#endif
+        default:
+            return f(scalar::kernels{});
+    }
+}
+
+} // namespace detail
+
+// The instruction set the kernels currently use
+inline isa active_isa() noexcept {
+    return detail::selected_isa();
+}
+
+// Forces a narrower instruction set (for testing and benchmarking); requests wider than the CPU supports are
+// clamped. Not thread-safe with respect to running kernels
+inline isa use_isa(isa requested) noexcept {
+    isa best = detail::detect_isa();
+    detail::selected_isa() = static_cast<int>(requested) < static_cast<int>(best) ? requested : best;
+    return detail::selected_isa();
+}
+
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+typename unrolled_list<T, NodeMaxSize, Allocator, Counters>::const_iterator
+find(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list, T value) {
+    return detail::dispatch([&](auto k) {
+        for (auto it = list.begin(); it != list.end(); it = it.next_segment()) {
+            auto segment = it.segment();
+            size_t index = k.find(segment.data(), segment.size(), value);
+            if (index != segment.size())
+                return it + static_cast<std::ptrdiff_t>(index);
+        }
+        return list.end();
+    });
+}
+
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+size_t count(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list, T value) {
+    return detail::dispatch([&](auto k) {
+        size_t result = 0;
+        for (std::span<const T> segment: list.segments())
+            result += k.count(segment.data(), segment.size(), value);
+        return result;
+    });
+}
+
+// The list must not be empty
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+std::pair<T, T> minmax(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    return detail::dispatch([&](auto k) {
+        std::pair<T, T> result(list.front(), list.front());
+        for (std::span<const T> segment: list.segments()) {
+            T lo, hi;
+            k.minmax(segment.data(), segment.size(), lo, hi);
+            if (lo < result.first)
+                result.first = lo;
+            if (result.second < hi)
+                result.second = hi;
+        }
+        return result;
+    });
+}
+
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+T min(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    return minmax(list).first;
+}
+
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+T max(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    return minmax(list).second;
+}
+
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters>
+sum_t<T> sum(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list) {
+    return detail::dispatch([&](auto k) {
+        sum_t<T> result = 0;
+        for (std::span<const T> segment: list.segments())
+            result += k.sum(segment.data(), segment.size());
+        return result;
+    });
+}
+
+// Writes every element e for which `e op value` holds to out, keeping the list order
+template<element T, size_t NodeMaxSize, typename Allocator, typename Counters, typename OutputIt>
+OutputIt filter(const unrolled_list<T, NodeMaxSize, Allocator, Counters> &list, compare op, T value, OutputIt out) {
+    return detail::dispatch([&](auto k) {
+        for (std::span<const T> segment: list.segments())
+            out = k.filter(segment.data(), segment.size(), op, value, out);
+        return out;
+    });
+}
+
+} // namespace unrolled::simd
@@ -0,0 +1,122 @@
+// Kernels shared by every instruction set in unrolled_simd.h.
+// This file is included once per instruction-set namespace, each of which defines its own vec<T> traits first,
+// so it deliberately has no include guard
+
+struct kernels {
+    template<typename T>
+    static unsigned match_mask(compare op, typename vec<T>::reg a, typename vec<T>::reg b) {
+        switch (op) {
+            case compare::equal:
+                return vec<T>::eq(a, b);
+            case compare::not_equal:
+                return ~vec<T>::eq(a, b) & ((1u << vec<T>::lanes) - 1);
+            case compare::less:
+                return vec<T>::lt(a, b);
+            default:
+                return vec<T>::gt(a, b);
+        }
+    }
+
+    template<typename T>
+    static bool matches(compare op, T a, T b) {
+        switch (op) {
+            case compare::equal:
+                return a == b;
+            case compare::not_equal:
+                return a != b;
+            case compare::less:
+                return a < b;
+            default:
+                return a > b;
+        }
+    }
+
+    template<typename T>
+    static size_t find(const T *data, size_t n, T value) {
+        using V = vec<T>;
+        size_t i = 0;
+        typename V::reg needle = V::set1(value);
+        for (; i + V::lanes <= n; i += V::lanes) {
+            unsigned mask = V::eq(V::load(data + i), needle);
+            if (mask)
+                return i + std::countr_zero(mask);
+        }
+        for (; i < n; ++i) {
+            if (data[i] == value)
+                return i;
+        }
+        return n;
+    }
+
+    template<typename T>
+    static size_t count(const T *data, size_t n, T value) {
+        using V = vec<T>;
+        size_t result = 0;
+        size_t i = 0;
+        typename V::reg needle = V::set1(value);
+        for (; i + V::lanes <= n; i += V::lanes)
+            result += std::popcount(V::eq(V::load(data + i), needle));
+        for (; i < n; ++i)
+            result += data[i] == value;
+        return result;
+    }
+
+    // n must be positive
+    template<typename T>
+    static void minmax(const T *data, size_t n, T &lo, T &hi) {
+        using V = vec<T>;
+        size_t i = 0;
+        if (n >= V::lanes) {
+            typename V::reg vlo = V::load(data);
+            typename V::reg vhi = vlo;
+            for (i = V::lanes; i + V::lanes <= n; i += V::lanes) {
+                typename V::reg v = V::load(data + i);
+                vlo = V::min(vlo, v);
+                vhi = V::max(vhi, v);
+            }
+            lo = V::hmin(vlo);
+            hi = V::hmax(vhi);
+        } else {
+            lo = hi = data[0];
+            i = 1;
+        }
+        for (; i < n; ++i) {
+            if (data[i] < lo)
+                lo = data[i];
+            if (hi < data[i])
+                hi = data[i];
+        }
+    }
+
+    template<typename T>
+    static sum_t<T> sum(const T *data, size_t n) {
+        using V = vec<T>;
+        size_t i = 0;
+        typename V::acc total = V::zero();
+        for (; i + V::lanes <= n; i += V::lanes)
+            total = V::add(total, V::load(data + i));
+        sum_t<T> result = V::hsum(total);
+        for (; i < n; ++i)
+            result += data[i];
+        return result;
+    }
+
+    template<typename T, typename OutputIt>
+    static OutputIt filter(const T *data, size_t n, compare op, T value, OutputIt out) {
+        using V = vec<T>;
+        size_t i = 0;
+        typename V::reg needle = V::set1(value);
+        for (; i + V::lanes <= n; i += V::lanes) {
+            unsigned mask = match_mask<T>(op, V::load(data + i), needle);
+            while (mask) {
+                *out++ = data[i + std::countr_zero(mask)];
+                mask &= mask - 1;
+            }
+        }
+        for (; i < n; ++i) {
+            if (matches<T>(op, data[i], value))
+                *out++ = data[i];
+        }
+        return out;
+    }
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace unrolled {
+
+namespace detail {
+
+// Fixed-size blocks carved out of large chunks. Every thread allocates from and frees to its own free list;
+// the lists exchange blocks with a shared depot in batches, so the mutex is taken once per `batch` operations.
+// Chunks are kept until the process exits and their blocks are reused by later allocations of the same size.
+// Once a thread's free list has been destroyed at thread exit, that thread takes and returns blocks through
+// the depot one at a time, so lists with static or thread storage duration can still free their nodes
+template<size_t Size, size_t Align>
+class slab_pool {
+private:
+    struct Block {
+        Block *next;
+    };
+
+    // Start of every chunk, linking the chunks so that they stay reachable
+    struct Chunk {
+        Chunk *next;
+    };
+
+    static constexpr size_t block_align = std::max(Align, alignof(Block));
+    static constexpr size_t block_size =
+        (std::max(Size, sizeof(Block)) + block_align - 1) / block_align * block_align;
+    static constexpr size_t chunk_header = (sizeof(Chunk) + block_align - 1) / block_align * block_align;
+    static constexpr size_t chunk_size = std::max<size_t>(64 * 1024, chunk_header + block_size * 16);
+    static constexpr size_t batch = std::max<size_t>(chunk_size / block_size / 4, 1);
+
+    struct Depot {
+        std::mutex mutex;
+        Block *free = nullptr;
+        Chunk *chunks = nullptr;
+
+        // Carves a new chunk into free blocks; the mutex must be held
+        void grow() {
+            auto *chunk = static_cast<std::byte *>(::operator new(chunk_size, std::align_val_t(block_align)));
+            chunks = new(chunk) Chunk{chunks};
+            for (size_t offset = chunk_header; offset + block_size <= chunk_size; offset += block_size) {
+                auto *block = reinterpret_cast<Block *>(chunk + offset);
+                block->next = free;
+                free = block;
+            }
+        }
+    };
+
+    struct Cache {
+        Block *free = nullptr;
+        size_t count = 0;
+
+        ~Cache() {
+            give_back(count);
+            cache_destroyed() = true;
+        }
+
+        void take_from_depot() {
+            Depot &d = depot();
+            std::lock_guard lock(d.mutex);
+            if (!d.free)
+                d.grow();
+            for (size_t i = 0; i < batch && d.free; ++i) {
+                Block *block = d.free;
+                d.free = block->next;
+                block->next = free;
+                free = block;
+                ++count;
+            }
+        }
+
+        void give_back(size_t n) noexcept {
+            if (n == 0)
+                return;
+            Block *first = free;
+            Block *last = first;
+            for (size_t i = 1; i < n; ++i)
+                last = last->next;
+            free = last->next;
+            count -= n;
+
+            Depot &d = depot();
+            std::lock_guard lock(d.mutex);
+            last->next = d.free;
+            d.free = first;
+        }
+    };
+
+    // Never destroyed, so lists with static storage duration can still free their nodes at exit
+    static Depot &depot() {
+        static Depot *instance = new Depot;
+        return *instance;
+    }
+
+    static Cache &cache() {
+        thread_local Cache instance;
+        return instance;
+    }
+
+    // Trivially destructible, so it can still be read after the thread's Cache is gone
+    static bool &cache_destroyed() noexcept {
+        thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+public:
+    static void *allocate() {
+        if (cache_destroyed()) {
+            Depot &d = depot();
+            std::lock_guard lock(d.mutex);
+            if (!d.free)
+                d.grow();
+            Block *block = d.free;
+            d.free = block->next;
+            return block;
+        }
+        Cache &c = cache();
+        if (!c.free)
+            c.take_from_depot();
+        Block *block = c.free;
+        c.free = block->next;
+        --c.count;
+        return block;
+    }
+
+    static void deallocate(void *p) noexcept {
+        auto *block = static_cast<Block *>(p);
+        if (cache_destroyed()) {
+            Depot &d = depot();
+            std::lock_guard lock(d.mutex);
+            block->next = d.free;
+            d.free = block;
+            return;
+        }
+        Cache &c = cache();
+        block->next = c.free;
+        c.free = block;
+        ++c.count;
+        if (c.count >= 2 * batch)
+            c.give_back(batch);
+    }
+};
+
+} // namespace detail
+
+// Stateless allocator that serves single-object allocations (the nodes of unrolled_list) from slab_pool and
+// forwards array allocations to std::allocator
+template<typename T>
+class slab_allocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    slab_allocator() noexcept = default;
+
+    template<typename U>
+    slab_allocator(const slab_allocator<U> &) noexcept {
+    }
+
+    T *allocate(size_t n) {
+        if (n == 1)
+            return static_cast<T *>(detail::slab_pool<sizeof(T), alignof(T)>::allocate());
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        if (n == 1)
+            detail::slab_pool<sizeof(T), alignof(T)>::deallocate(p);
+        else
+            std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const slab_allocator<U> &) const noexcept {
+        return true;
+    }
+};
+
+template<typename T, size_t NodeMaxSize = 10>
+using slab_unrolled_list = unrolled_list<T, NodeMaxSize, slab_allocator<T> >;
+
+} // namespace unrolled
@@ -0,0 +1,595 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace unrolled {
+
+// Element of a basic_soa_unrolled_list seen through its columns. get<I>() and structured bindings refer to the
+// fields in place; conversion to std::tuple<Fields...> copies the element and assigning a tuple overwrites it
+template<bool IsConst, typename Node, typename... Fields>
+class soa_reference {
+private:
+    template<size_t I>
+    using field = std::tuple_element_t<I, std::tuple<Fields...> >;
+
+    Node *node;
+    size_t index;
+
+    template<size_t... I>
+    std::tuple<Fields...> load(std::index_sequence<I...>) const {
+        return {get<I>()...};
+    }
+
+    template<size_t... I>
+    void store(const std::tuple<Fields...> &value, std::index_sequence<I...>) const {
+        ((get<I>() = std::get<I>(value)), ...);
+    }
+
+public:
+    soa_reference(Node *n, size_t i) noexcept : node(n), index(i) {
+    }
+
+    soa_reference(const soa_reference &) = default;
+
+    template<bool B = IsConst, typename = std::enable_if_t<B> >
+    soa_reference(const soa_reference<false, Node, Fields...> &other) noexcept
+        : soa_reference(other.node_ptr(), other.position()) {
+    }
+
+    template<size_t I>
+    std::conditional_t<IsConst, const field<I> &, field<I> &> get() const noexcept {
+        return node->template column<I>()[index];
+    }
+
+    operator std::tuple<Fields...>() const {
+        return load(std::index_sequence_for<Fields...>());
+    }
+
+    // Assignment writes through to the element instead of rebinding the reference
+    const soa_reference &operator=(const std::tuple<Fields...> &value) const requires (!IsConst) {
+        store(value, std::index_sequence_for<Fields...>());
+        return *this;
+    }
+
+    const soa_reference &operator=(const soa_reference &other) const requires (!IsConst) {
+        return *this = std::tuple<Fields...>(other);
+    }
+
+    friend bool operator==(const soa_reference &lhs, const std::tuple<Fields...> &rhs) {
+        return std::tuple<Fields...>(lhs) == rhs;
+    }
+
+    Node *node_ptr() const noexcept { return node; }
+    size_t position() const noexcept { return index; }
+};
+
+// Unrolled list of records stored as a structure of arrays: each node holds one contiguous, cache-line aligned column
+// per field, so a scan over one field reads only that field's bytes and compiles to plain loops over arrays.
+// Elements are accessed through soa_reference proxies; column<I>() walks field I node by node as spans.
+// Fields must be trivially copyable, which lets nodes shift and copy columns with memmove. Elements start at the
+// front of their node, so push_front and pop_front shift the head node
+template<size_t NodeMaxSize, typename Allocator, typename... Fields>
+class basic_soa_unrolled_list {
+private:
+    static_assert(sizeof...(Fields) > 0);
+    static_assert(NodeMaxSize >= 2);
+    static_assert((std::is_trivially_copyable_v<Fields> && ...), "soa_unrolled_list fields must be trivially copyable");
+    static_assert(((alignof(Fields) <= cache_line_size) && ...));
+
+    template<size_t I>
+    using field = std::tuple_element_t<I, std::tuple<Fields...> >;
+
+    static constexpr size_t column_bytes(size_t bytes) {
+        return (bytes * NodeMaxSize + cache_line_size - 1) / cache_line_size * cache_line_size;
+    }
+
+    // Column I occupies bytes [column_offsets[I], column_offsets[I] + sizeof(field<I>) * NodeMaxSize) of a node
+    static constexpr std::array<size_t, sizeof...(Fields)> column_offsets = [] {
+        std::array<size_t, sizeof...(Fields)> offsets{};
+        size_t offset = 0;
+        size_t i = 0;
+        ((offsets[i++] = offset, offset += column_bytes(sizeof(Fields))), ...);
+        return offsets;
+    }();
+
+    static constexpr size_t storage_bytes = (column_bytes(sizeof(Fields)) + ...);
+
+    struct alignas(cache_line_size) Node {
+        Node *next = nullptr;
+        Node *prev = nullptr;
+        size_t size = 0;
+        alignas(cache_line_size) std::byte storage[storage_bytes];
+
+        // User-provided, so that allocating a node does not zero its columns
+        Node() noexcept {
+        }
+
+        template<size_t I>
+        field<I> *column() noexcept {
+            return reinterpret_cast<field<I> *>(storage + column_offsets[I]);
+        }
+
+        template<size_t I>
+        const field<I> *column() const noexcept {
+            return reinterpret_cast<const field<I> *>(storage + column_offsets[I]);
+        }
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    Node *head = nullptr;
+    Node *tail = nullptr;
+    size_t total_size = 0;
+    Allocator alloc;
+    NodeAllocator node_alloc;
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using allocator_type = Allocator;
+    using reference = soa_reference<false, Node, Fields...>;
+    using const_reference = soa_reference<true, Node, Fields...>;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+
+    // Bidirectional iterators whose reference is a proxy, as with std::vector<bool>
+    template<bool IsConst>
+    struct Iterator {
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using pointer = void;
+        using reference = soa_reference<IsConst, Node, Fields...>;
+        using difference_type = std::ptrdiff_t;
+
+        Node *node = nullptr;
+        size_t index = 0;
+        const basic_soa_unrolled_list *parent = nullptr;
+
+        Iterator() = default;
+
+        Iterator(Node *n, size_t i, const basic_soa_unrolled_list *p) : node(n), index(i), parent(p) {
+        }
+
+        template<bool B = IsConst, typename = std::enable_if_t<B> >
+        Iterator(const Iterator<false> &other) : node(other.node), index(other.index), parent(other.parent) {
+        }
+
+        reference operator*() const { return reference(node, index); }
+
+        Iterator &operator++() {
+            if (!node) return *this;
+            if (index + 1 < node->size) {
+                ++index;
+            } else {
+                node = node->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        Iterator &operator--() {
+            if (!node) {
+                node = parent->tail;
+                if (node)
+                    index = node->size - 1;
+            } else if (index > 0) {
+                --index;
+            } else {
+                node = node->prev;
+                if (node)
+                    index = node->size - 1;
+            }
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        template<bool OtherConst>
+        bool operator==(const Iterator<OtherConst> &other) const {
+            return node == other.node && index == other.index;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Walks the list node by node, yielding the node's part of column I as one contiguous span
+    template<size_t I, bool IsConst>
+    struct ColumnIterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::span<std::conditional_t<IsConst, const field<I>, field<I> > >;
+        using pointer = void;
+        using reference = value_type;
+        using difference_type = std::ptrdiff_t;
+
+        Node *node = nullptr;
+
+        value_type operator*() const { return value_type(node->template column<I>(), node->size); }
+
+        ColumnIterator &operator++() {
+            node = node->next;
+            return *this;
+        }
+
+        ColumnIterator operator++(int) {
+            ColumnIterator tmp = *this;
+            node = node->next;
+            return tmp;
+        }
+
+        bool operator==(const ColumnIterator &other) const { return node == other.node; }
+    };
+
+    template<size_t I, bool IsConst>
+    struct ColumnRange {
+        Node *first = nullptr;
+
+        ColumnIterator<I, IsConst> begin() const { return {first}; }
+        ColumnIterator<I, IsConst> end() const { return {nullptr}; }
+    };
+
+    explicit basic_soa_unrolled_list(const Allocator &a = Allocator())
+        : alloc(a), node_alloc(a) {
+    }
+
+    basic_soa_unrolled_list(std::initializer_list<value_type> init, const Allocator &a = Allocator())
+        : alloc(a), node_alloc(a) {
+        try {
+            for (const value_type &value: init)
+                push_back(value);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    basic_soa_unrolled_list(const basic_soa_unrolled_list &other)
+        : basic_soa_unrolled_list(other,
+                                  std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc)) {
+    }
+
+    // Copies whole columns node by node
+    basic_soa_unrolled_list(const basic_soa_unrolled_list &other, const Allocator &a)
+        : alloc(a), node_alloc(a) {
+        try {
+            for (Node *node = other.head; node; node = node->next) {
+                Node *copy = create_node();
+                link_after(tail, copy);
+                move_elements(copy, 0, node, 0, node->size);
+                copy->size = node->size;
+                total_size += node->size;
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    basic_soa_unrolled_list(basic_soa_unrolled_list &&other) noexcept
+        : alloc(other.alloc), node_alloc(other.node_alloc) {
+        swap_contents(other);
+    }
+
+    ~basic_soa_unrolled_list() {
+        clear();
+    }
+
+    basic_soa_unrolled_list &operator=(const basic_soa_unrolled_list &other) {
+        if (this != &other) {
+            constexpr bool propagate =
+                std::allocator_traits<Allocator>::propagate_on_container_copy_assignment::value;
+            basic_soa_unrolled_list tmp(other, propagate ? other.alloc : alloc);
+            if constexpr (propagate) {
+                clear();
+                alloc = other.alloc;
+                node_alloc = other.node_alloc;
+            }
+            swap_contents(tmp);
+        }
+        return *this;
+    }
+
+    basic_soa_unrolled_list &operator=(basic_soa_unrolled_list &&other) noexcept(
+        std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value ||
+        std::allocator_traits<Allocator>::is_always_equal::value
+    ) {
+        if (this != &other) {
+            constexpr bool propagate =
+                std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value;
+            if (propagate || node_alloc == other.node_alloc) {
+                clear();
+                if constexpr (propagate) {
+                    alloc = other.alloc;
+                    node_alloc = other.node_alloc;
+                }
+                swap_contents(other);
+            } else {
+                *this = static_cast<const basic_soa_unrolled_list &>(other);
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    void swap(basic_soa_unrolled_list &other) noexcept {
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc, other.alloc);
+            swap(node_alloc, other.node_alloc);
+        }
+        swap_contents(other);
+    }
+
+    friend void swap(basic_soa_unrolled_list &lhs, basic_soa_unrolled_list &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    allocator_type get_allocator() const { return alloc; }
+
+    iterator begin() noexcept { return iterator(head, 0, this); }
+    const_iterator begin() const noexcept { return const_iterator(head, 0, this); }
+    const_iterator cbegin() const noexcept { return const_iterator(head, 0, this); }
+    iterator end() noexcept { return iterator(nullptr, 0, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, 0, this); }
+    const_iterator cend() const noexcept { return const_iterator(nullptr, 0, this); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // for (std::span<float> xs: list.column<0>()) ...
+    template<size_t I>
+    ColumnRange<I, false> column() noexcept { return {head}; }
+
+    template<size_t I>
+    ColumnRange<I, true> column() const noexcept { return {head}; }
+
+    size_type size() const noexcept { return total_size; }
+    bool empty() const noexcept { return total_size == 0; }
+    static constexpr size_type max_node_size() noexcept { return NodeMaxSize; }
+
+    reference front() { return reference(head, 0); }
+    const_reference front() const { return const_reference(head, 0); }
+    reference back() { return reference(tail, tail->size - 1); }
+    const_reference back() const { return const_reference(tail, tail->size - 1); }
+
+    void clear() noexcept {
+        while (head) {
+            Node *next = head->next;
+            destroy_node(head);
+            head = next;
+        }
+        tail = nullptr;
+        total_size = 0;
+    }
+
+    void push_back(const value_type &value) {
+        if (!tail || tail->size == NodeMaxSize)
+            link_after(tail, create_node());
+        store(tail, tail->size, value);
+        ++tail->size;
+        ++total_size;
+    }
+
+    void emplace_back(const Fields &... fields) {
+        push_back(value_type(fields...));
+    }
+
+    void push_front(const value_type &value) {
+        insert(begin(), value);
+    }
+
+    void emplace_front(const Fields &... fields) {
+        push_front(value_type(fields...));
+    }
+
+    // Like unrolled_list, popping from an empty list does nothing
+    void pop_back() noexcept {
+        if (tail)
+            erase_in_node(tail, tail->size - 1);
+    }
+
+    void pop_front() noexcept {
+        if (head)
+            erase_in_node(head, 0);
+    }
+
+    // Inserts into a full node by first splitting it in half
+    iterator insert(const_iterator pos, const value_type &value) {
+        if (!pos.node) {
+            push_back(value);
+            return iterator(tail, tail->size - 1, this);
+        }
+        Node *node = pos.node;
+        size_t index = pos.index;
+        if (node->size == NodeMaxSize) {
+            Node *new_node = create_node();
+            size_t mid = NodeMaxSize / 2;
+            move_elements(new_node, 0, node, mid, node->size - mid);
+            new_node->size = node->size - mid;
+            node->size = mid;
+            link_after(node, new_node);
+            if (index > mid) {
+                node = new_node;
+                index -= mid;
+            }
+        }
+        move_elements(node, index + 1, node, index, node->size - index);
+        store(node, index, value);
+        ++node->size;
+        ++total_size;
+        return iterator(node, index, this);
+    }
+
+    iterator emplace(const_iterator pos, const Fields &... fields) {
+        return insert(pos, value_type(fields...));
+    }
+
+    // Returns the iterator following the erased element
+    iterator erase(const_iterator pos) noexcept {
+        return erase_in_node(pos.node, pos.index);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        iterator it(first.node, first.index, this);
+        for (difference_type n = std::distance(first, last); n > 0; --n)
+            it = erase(it);
+        return it;
+    }
+
+    friend bool operator==(const basic_soa_unrolled_list &lhs, const basic_soa_unrolled_list &rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r) {
+            if (value_type(*l) != value_type(*r))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    template<typename F>
+    static void for_each_column(F &&f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (f(std::integral_constant<size_t, I>()), ...);
+        }(std::index_sequence_for<Fields...>());
+    }
+
+    // Copies count elements column by column; the ranges may overlap when dst == src
+    static void move_elements(Node *dst, size_t dst_index, Node *src, size_t src_index, size_t count) noexcept {
+        if (count == 0)
+            return;
+        for_each_column([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            std::memmove(dst->template column<I>() + dst_index, src->template column<I>() + src_index,
+                         count * sizeof(field<I>));
+        });
+    }
+
+    static void store(Node *node, size_t index, const value_type &value) noexcept {
+        for_each_column([&](auto i) {
+            constexpr size_t I = decltype(i)::value;
+            node->template column<I>()[index] = std::get<I>(value);
+        });
+    }
+
+    Node *create_node() {
+        Node *node = NodeTraits::allocate(node_alloc, 1);
+        NodeTraits::construct(node_alloc, node);
+        return node;
+    }
+
+    void destroy_node(Node *node) noexcept {
+        NodeTraits::destroy(node_alloc, node);
+        NodeTraits::deallocate(node_alloc, node, 1);
+    }
+
+    // Links new_node after node, or as the head when node is nullptr
+    void link_after(Node *node, Node *new_node) noexcept {
+        Node *next = node ? node->next : head;
+        new_node->prev = node;
+        new_node->next = next;
+        if (node)
+            node->next = new_node;
+        else
+            head = new_node;
+        if (next)
+            next->prev = new_node;
+        else
+            tail = new_node;
+    }
+
+    void remove_node(Node *node) noexcept {
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            head = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        else
+            tail = node->prev;
+        destroy_node(node);
+    }
+
+    void merge_with_next(Node *node) noexcept {
+        Node *next = node->next;
+        move_elements(node, node->size, next, 0, next->size);
+        node->size += next->size;
+        remove_node(next);
+    }
+
+    // Keeps the node at least half full by merging it with a neighbour when their elements fit in one node
+    iterator erase_in_node(Node *node, size_t index) noexcept {
+        move_elements(node, index, node, index + 1, node->size - index - 1);
+        --node->size;
+        --total_size;
+
+        if (node->size == 0) {
+            Node *next = node->next;
+            remove_node(node);
+            return iterator(next, 0, this);
+        }
+
+        if (node->size < NodeMaxSize / 2) {
+            if (node->next && node->size + node->next->size <= NodeMaxSize) {
+                merge_with_next(node);
+            } else if (node->prev && node->prev->size + node->size <= NodeMaxSize) {
+                Node *prev = node->prev;
+                index += prev->size;
+                merge_with_next(prev);
+                node = prev;
+            }
+        }
+
+        if (index == node->size)
+            return iterator(node->next, 0, this);
+        return iterator(node, index, this);
+    }
+
+    void swap_contents(basic_soa_unrolled_list &other) noexcept {
+        using std::swap;
+        swap(head, other.head);
+        swap(tail, other.tail);
+        swap(total_size, other.total_size);
+    }
+};
+
+template<typename... Fields>
+using soa_unrolled_list = basic_soa_unrolled_list<128, std::allocator<std::tuple<Fields...> >, Fields...>;
+
+} // namespace unrolled
+
+// Structured bindings over soa_reference bind to the fields in place: auto [x, y] = *it;
+template<bool IsConst, typename Node, typename... Fields>
+struct std::tuple_size<unrolled::soa_reference<IsConst, Node, Fields...> >
+    : std::integral_constant<size_t, sizeof...(Fields)> {
+};
+
+template<size_t I, bool IsConst, typename Node, typename... Fields>
+struct std::tuple_element<I, unrolled::soa_reference<IsConst, Node, Fields...> > {
+    using field = std::tuple_element_t<I, std::tuple<Fields...> >;
+    using type = std::conditional_t<IsConst, const field &, field &>;
+};
@@ -0,0 +1,368 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace unrolled {
+
+// Sorted multiset stored as an unrolled_list, i.e. the leaf level of a B+-tree: a directory holds the nodes in order,
+// and the first and last elements of every node act as its key fences. Lookups binary-search the directory by the
+// fences and then the node itself, so they cost O(log n) comparisons. Insertion goes through the list's
+// split-on-full path and keeps equal elements in insertion order; only node splits and merges touch the directory.
+// Elements are exposed read-only, since changing them could break the order
+template<typename T, size_t NodeMaxSize = 10, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class sorted_unrolled_list {
+private:
+    using List = unrolled_list<T, NodeMaxSize, Allocator>;
+    using Node = typename List::Node;
+    using DirectoryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node *>;
+    using DirectoryTraits = std::allocator_traits<DirectoryAllocator>;
+
+    List list;
+    [[no_unique_address]] Compare comp;
+    // Mutable so that const lookups can rebuild it. Only move assignment and failed inserts leave it invalid;
+    // concurrent const lookups are safe once a lookup or a successful insert or erase has followed those
+    mutable Node **directory = nullptr;
+    mutable size_t directory_size = 0;
+    mutable size_t directory_capacity = 0;
+    // Cleared when the nodes changed in a way that was not mirrored; the next lookup rebuilds the directory
+    mutable bool directory_valid = true;
+
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const T &;
+    using const_reference = const T &;
+    using iterator = typename List::const_iterator;
+    using const_iterator = typename List::const_iterator;
+    using reverse_iterator = std::reverse_iterator<const_iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using const_segment_range = typename List::const_segment_range;
+
+    explicit sorted_unrolled_list(const Compare &c = Compare(), const Allocator &a = Allocator())
+        : list(a), comp(c) {
+    }
+
+    explicit sorted_unrolled_list(const Allocator &a)
+        : list(a) {
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    sorted_unrolled_list(InputIt first, InputIt last, const Compare &c = Compare(), const Allocator &a = Allocator())
+        : list(first, last, a), comp(c), directory_valid(false) {
+        list.sort(comp);
+        ensure_directory();
+    }
+
+    sorted_unrolled_list(std::initializer_list<T> init, const Compare &c = Compare(),
+                         const Allocator &a = Allocator())
+        : sorted_unrolled_list(init.begin(), init.end(), c, a) {
+    }
+
+    sorted_unrolled_list(const sorted_unrolled_list &other)
+        : list(other.list), comp(other.comp), directory_valid(false) {
+        ensure_directory();
+    }
+
+    sorted_unrolled_list(sorted_unrolled_list &&other) noexcept
+        : list(std::move(other.list)), comp(other.comp) {
+        swap_directory(other);
+    }
+
+    ~sorted_unrolled_list() {
+        release_directory();
+    }
+
+    sorted_unrolled_list &operator=(const sorted_unrolled_list &other) {
+        if (this != &other) {
+            // Released first: the directory was allocated with the list's allocator, which the assignment may replace.
+            // Left empty and invalid, so that a throwing list assignment leaves it to be rebuilt by the next lookup
+            release_directory();
+            directory_size = 0;
+            directory_valid = false;
+            list = other.list;
+            comp = other.comp;
+            ensure_directory();
+        }
+        return *this;
+    }
+
+    sorted_unrolled_list &operator=(sorted_unrolled_list &&other) noexcept(
+        noexcept(std::declval<List &>() = std::declval<List &&>())
+    ) {
+        if (this != &other) {
+            release_directory();
+            directory_size = 0;
+            directory_valid = false;
+            other.directory_valid = false;
+            list = std::move(other.list);
+            comp = other.comp;
+        }
+        return *this;
+    }
+
+    void swap(sorted_unrolled_list &other) noexcept {
+        using std::swap;
+        list.swap(other.list);
+        swap(comp, other.comp);
+        swap_directory(other);
+    }
+
+    friend void swap(sorted_unrolled_list &lhs, sorted_unrolled_list &rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    const_iterator begin() const noexcept { return list.begin(); }
+    const_iterator cbegin() const noexcept { return list.cbegin(); }
+    const_iterator end() const noexcept { return list.end(); }
+    const_iterator cend() const noexcept { return list.cend(); }
+    const_reverse_iterator rbegin() const noexcept { return list.rbegin(); }
+    const_reverse_iterator rend() const noexcept { return list.rend(); }
+
+    const_segment_range segments() const noexcept { return list.segments(); }
+
+    size_type size() const noexcept { return list.size(); }
+    bool empty() const noexcept { return list.empty(); }
+    static constexpr size_type max_node_size() noexcept { return List::max_node_size(); }
+
+    const_reference front() const { return list.front(); }
+    const_reference back() const { return list.back(); }
+    const_reference operator[](size_type pos) const { return list[pos]; }
+
+    key_compare key_comp() const { return comp; }
+    allocator_type get_allocator() const { return list.get_allocator(); }
+
+    void clear() noexcept {
+        list.clear();
+        directory_size = 0;
+        directory_valid = true;
+    }
+
+    // Inserts after all elements equal to value
+    const_iterator insert(const T &value) {
+        return emplace_at(value, value);
+    }
+
+    const_iterator insert(T &&value) {
+        return emplace_at(value, std::move(value));
+    }
+
+    template<typename InputIt, typename = typename std::iterator_traits<InputIt>::iterator_category>
+    void insert(InputIt first, InputIt last) {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+
+    template<typename... Args>
+    const_iterator emplace(Args &&... args) {
+        T value(std::forward<Args>(args)...);
+        return emplace_at(value, std::move(value));
+    }
+
+    // Lookups take any key comparable with T through Compare
+
+    template<typename K>
+    const_iterator lower_bound(const K &key) const {
+        size_t d = node_partition([&](const Node *node) { return comp(last_of(node), key); });
+        if (d == directory_size)
+            return end();
+        Node *node = directory[d];
+        const T *first = node->element_ptr(0);
+        size_t index = std::lower_bound(first, first + node->size, key, comp) - first;
+        return const_iterator(node, index, &list);
+    }
+
+    template<typename K>
+    const_iterator upper_bound(const K &key) const {
+        size_t d = node_partition([&](const Node *node) { return !comp(key, last_of(node)); });
+        if (d == directory_size)
+            return end();
+        Node *node = directory[d];
+        const T *first = node->element_ptr(0);
+        size_t index = std::upper_bound(first, first + node->size, key, comp) - first;
+        return const_iterator(node, index, &list);
+    }
+
+    template<typename K>
+    std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    template<typename K>
+    const_iterator find(const K &key) const {
+        const_iterator it = lower_bound(key);
+        if (it != end() && !comp(key, *it))
+            return it;
+        return end();
+    }
+
+    template<typename K>
+    bool contains(const K &key) const {
+        return find(key) != end();
+    }
+
+    template<typename K>
+    size_type count(const K &key) const {
+        auto [first, last] = equal_range(key);
+        return static_cast<size_type>(distance(first, last));
+    }
+
+    // Returns the iterator following the erased element
+    const_iterator erase(const_iterator pos) {
+        Node *node = pos.node;
+        size_t d = directory_position(node);
+        Node *prev = node->prev;
+        Node *next = node->next;
+        auto it = list.erase_in_node(node, pos.index, 1);
+        // Pointers are only compared here: node and next may have been freed by a merge
+        bool node_alive = prev ? prev->next == node : list.head == node;
+        if (!node_alive)
+            directory_erase(d);
+        else if (node->next != next) {
+            // A merge took the next node, or a split added one for elements that may throw when relocated
+            if constexpr (List::nothrow_relocatable)
+                directory_erase(d + 1);
+            else
+                directory_insert(d + 1, node->next);
+        }
+        return it;
+    }
+
+    template<typename K>
+    size_type erase(const K &key) {
+        size_type removed = 0;
+        for (const_iterator it = find(key); it != end() && !comp(key, *it); it = erase(it))
+            ++removed;
+        return removed;
+    }
+
+private:
+    static const T &last_of(const Node *node) noexcept {
+        return *node->element_ptr(node->size - 1);
+    }
+
+    // Index of the first node of the directory for which below(node) is false
+    template<typename Below>
+    size_t node_partition(Below below) const {
+        ensure_directory();
+        return std::partition_point(directory, directory + directory_size, below) - directory;
+    }
+
+    template<typename Value>
+    const_iterator emplace_at(const T &key, Value &&value) {
+        if (list.empty()) {
+            reserve_directory(1);
+            list.emplace_back(std::forward<Value>(value));
+            directory[0] = list.head;
+            directory_size = 1;
+            directory_valid = true;
+            return begin();
+        }
+        size_t d = node_partition([&](const Node *node) { return !comp(key, last_of(node)); });
+        Node *node;
+        size_t index;
+        if (d == directory_size) {
+            node = directory[--d];
+            index = node->size;
+        } else {
+            node = directory[d];
+            const T *first = node->element_ptr(0);
+            index = std::upper_bound(first, first + node->size, key, comp) - first;
+        }
+        Node *prev = node->prev;
+        Node *next = node->next;
+        typename List::iterator it;
+        try {
+            it = list.emplace_in_node(node, index, std::forward<Value>(value));
+        } catch (...) {
+            directory_valid = false;
+            throw;
+        }
+        if (node->next != next)
+            directory_insert(d + 1, node->next);
+        else if (node->prev != prev)
+            directory_insert(d, node->prev);
+        return it;
+    }
+
+    // Position of a node in the directory: found by its fences, then by scanning nodes with equal fences
+    size_t directory_position(Node *node) const {
+        const T &key = *node->element_ptr(0);
+        size_t d = node_partition([&](const Node *other) { return comp(last_of(other), key); });
+        while (directory[d] != node)
+            ++d;
+        return d;
+    }
+
+    void ensure_directory() const {
+        if (directory_valid)
+            return;
+        size_t count = 0;
+        for (Node *node = list.head; node; node = node->next)
+            ++count;
+        reserve_directory(count);
+        directory_size = 0;
+        for (Node *node = list.head; node; node = node->next)
+            directory[directory_size++] = node;
+        directory_valid = true;
+    }
+
+    void reserve_directory(size_t count) const {
+        if (count <= directory_capacity)
+            return;
+        size_t capacity = std::max<size_t>({count, directory_capacity * 2, 16});
+        DirectoryAllocator directory_alloc(list.get_allocator());
+        Node **entries = DirectoryTraits::allocate(directory_alloc, capacity);
+        std::copy(directory, directory + directory_size, entries);
+        release_directory();
+        directory = entries;
+        directory_capacity = capacity;
+    }
+
+    void release_directory() const noexcept {
+        if (directory) {
+            DirectoryAllocator directory_alloc(list.get_allocator());
+            DirectoryTraits::deallocate(directory_alloc, directory, directory_capacity);
+        }
+        directory = nullptr;
+        directory_capacity = 0;
+    }
+
+    // A failed allocation leaves the directory to be rebuilt by the next lookup
+    void directory_insert(size_t d, Node *node) noexcept {
+        try {
+            reserve_directory(directory_size + 1);
+        } catch (...) {
+            directory_valid = false;
+            return;
+        }
+        std::copy_backward(directory + d, directory + directory_size, directory + directory_size + 1);
+        directory[d] = node;
+        ++directory_size;
+    }
+
+    void directory_erase(size_t d) noexcept {
+        std::copy(directory + d + 1, directory + directory_size, directory + d);
+        --directory_size;
+    }
+
+    // The directory holds nodes of the list it was built for, so it travels with the list's nodes
+    void swap_directory(sorted_unrolled_list &other) noexcept {
+        using std::swap;
+        swap(directory, other.directory);
+        swap(directory_size, other.directory_size);
+        swap(directory_capacity, other.directory_capacity);
+        swap(directory_valid, other.directory_valid);
+    }
+};
+
+} // namespace unrolled
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "unrolled_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+namespace unrolled {
+
+// Single-producer/single-consumer queue of unrolled nodes. The producer fills the tail node and publishes new
+// elements with one release store of the node size per call; the consumer drains the head node and hands drained
+// nodes back to the producer through a lock-free free list, so a queue in a steady state stops allocating.
+// try_push/try_emplace/try_push_n may run on one thread concurrently with try_pop/try_pop_n/empty on another.
+// The queue holds at most max_nodes nodes; pushes fail once they are all in use
+template<typename T, size_t NodeMaxSize = 64, typename Allocator = std::allocator<T> >
+class spsc_unrolled_queue {
+private:
+    static_assert(NodeMaxSize > 0);
+
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        // Elements [0, size) are constructed and visible to the consumer
+        std::atomic<size_t> size{0};
+        std::aligned_storage_t<sizeof(T), alignof(T)> elements[NodeMaxSize];
+
+        T *slot_ptr(size_t i) {
+            return reinterpret_cast<T *>(elements) + i;
+        }
+    };
+
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+    Allocator alloc;
+    NodeAllocator node_alloc;
+    size_t max_nodes;
+
+    // Producer side
+    alignas(cache_line_size) Node *tail = nullptr;
+    size_t tail_size = 0;
+    // Drained nodes already taken over by the producer, linked through next
+    Node *spare = nullptr;
+    size_t allocated_nodes = 0;
+
+    // Consumer side
+    alignas(cache_line_size) Node *head = nullptr;
+    size_t head_index = 0;
+
+    // Drained nodes pushed by the consumer and taken all at once by the producer
+    alignas(cache_line_size) std::atomic<Node *> recycled{nullptr};
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+
+    // At least two nodes are needed for the consumer to release a drained node while the producer fills the next
+    explicit spsc_unrolled_queue(size_type max_nodes = std::numeric_limits<size_type>::max(),
+                                 const Allocator &a = Allocator())
+        : alloc(a), node_alloc(a), max_nodes(std::max<size_type>(max_nodes, 2)) {
+        tail = head = allocate_node();
+    }
+
+    spsc_unrolled_queue(const spsc_unrolled_queue &) = delete;
+    spsc_unrolled_queue &operator=(const spsc_unrolled_queue &) = delete;
+
+    ~spsc_unrolled_queue() {
+        for (Node *node = head; node;) {
+            size_t size = node->size.load(std::memory_order_relaxed);
+            for (size_t i = node == head ? head_index : 0; i < size; ++i)
+                node->slot_ptr(i)->~T();
+            Node *next = node->next.load(std::memory_order_relaxed);
+            release_node(node);
+            node = next;
+        }
+        release_list(spare);
+        release_list(recycled.load(std::memory_order_acquire));
+    }
+
+    allocator_type get_allocator() const { return alloc; }
+
+    static constexpr size_type max_node_size() noexcept { return NodeMaxSize; }
+
+    // Producer side
+
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        if (tail_size == NodeMaxSize) {
+            Node *node = take_node();
+            if (!node)
+                return false;
+            try {
+                std::allocator_traits<Allocator>::construct(alloc, node->slot_ptr(0), std::forward<Args>(args)...);
+            } catch (...) {
+                keep_spare(node);
+                throw;
+            }
+            node->size.store(1, std::memory_order_relaxed);
+            tail->next.store(node, std::memory_order_release);
+            tail = node;
+            tail_size = 1;
+            return true;
+        }
+        std::allocator_traits<Allocator>::construct(alloc, tail->slot_ptr(tail_size), std::forward<Args>(args)...);
+        tail->size.store(++tail_size, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T &value) {
+        return try_emplace(value);
+    }
+
+    bool try_push(T &&value) {
+        return try_emplace(std::move(value));
+    }
+
+    // Copies up to n elements from first, publishing them once per node, and returns how many were pushed
+    template<typename InputIt>
+    size_type try_push_n(InputIt first, size_type n) {
+        size_type pushed = 0;
+        while (pushed < n) {
+            if (tail_size == NodeMaxSize) {
+                Node *node = take_node();
+                if (!node)
+                    break;
+                tail->next.store(node, std::memory_order_release);
+                tail = node;
+                tail_size = 0;
+            }
+            size_t k = std::min<size_type>(n - pushed, NodeMaxSize - tail_size);
+            size_t i = 0;
+            try {
+                for (; i < k; ++i, ++first)
+                    std::allocator_traits<Allocator>::construct(alloc, tail->slot_ptr(tail_size + i), *first);
+            } catch (...) {
+                tail_size += i;
+                tail->size.store(tail_size, std::memory_order_release);
+                throw;
+            }
+            tail_size += k;
+            pushed += k;
+            tail->size.store(tail_size, std::memory_order_release);
+        }
+        return pushed;
+    }
+
+    // Consumer side
+
+    bool try_pop(T &out) {
+        if (ready() == 0)
+            return false;
+        T *element = head->slot_ptr(head_index);
+        out = std::move(*element);
+        element->~T();
+        ++head_index;
+        return true;
+    }
+
+    // Moves up to n elements to out and returns how many were popped
+    template<typename OutputIt>
+    size_type try_pop_n(OutputIt out, size_type n) {
+        size_type popped = 0;
+        while (popped < n) {
+            size_t k = std::min<size_type>(ready(), n - popped);
+            if (k == 0)
+                break;
+            for (size_t i = 0; i < k; ++i) {
+                T *element = head->slot_ptr(head_index);
+                *out = std::move(*element);
+                ++out;
+                element->~T();
+                ++head_index;
+            }
+            popped += k;
+        }
+        return popped;
+    }
+
+    // Not const: moving past a drained head node recycles it
+    bool empty() {
+        return ready() == 0;
+    }
+
+private:
+    Node *allocate_node() {
+        Node *node = NodeTraits::allocate(node_alloc, 1);
+        NodeTraits::construct(node_alloc, node);
+        ++allocated_nodes;
+        return node;
+    }
+
+    void release_node(Node *node) noexcept {
+        NodeTraits::destroy(node_alloc, node);
+        NodeTraits::deallocate(node_alloc, node, 1);
+    }
+
+    void release_list(Node *node) noexcept {
+        while (node) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            release_node(node);
+            node = next;
+        }
+    }
+
+    // Producer: an empty node from the spare list, the recycled nodes or the allocator; nullptr at max_nodes
+    Node *take_node() {
+        if (!spare)
+            spare = recycled.exchange(nullptr, std::memory_order_acquire);
+        if (!spare)
+            return allocated_nodes < max_nodes ? allocate_node() : nullptr;
+        Node *node = spare;
+        spare = node->next.load(std::memory_order_relaxed);
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->size.store(0, std::memory_order_relaxed);
+        return node;
+    }
+
+    void keep_spare(Node *node) noexcept {
+        node->next.store(spare, std::memory_order_relaxed);
+        spare = node;
+    }
+
+    // Consumer: the number of elements ready in the head node. A drained full head node is passed back to the
+    // producer once the next node is linked; a head node that is not full may still receive elements
+    size_t ready() noexcept {
+        while (true) {
+            size_t size = head->size.load(std::memory_order_acquire);
+            if (head_index < size)
+                return size - head_index;
+            if (head_index < NodeMaxSize)
+                return 0;
+            Node *next = head->next.load(std::memory_order_acquire);
+            if (!next)
+                return 0;
+            Node *drained = head;
+            head = next;
+            head_index = 0;
+            recycle(drained);
+        }
+    }
+
+    void recycle(Node *node) noexcept {
+        Node *top = recycled.load(std::memory_order_relaxed);
+        do {
+            node->next.store(top, std::memory_order_relaxed);
+        } while (!recycled.compare_exchange_weak(top, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+};
+
+} // namespace unrolled
@@ -0,0 +1,89 @@
+#include <unrolled_algorithm.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <list>
+#include <numeric>
+#include <vector>
+
+/*
+    Тесты алгоритмов из unrolled_algorithm.h, которые обходят список по непрерывным участкам (нодам).
+    Результаты сравниваются с алгоритмами стандартной библиотеки на std::list с теми же элементами
+*/
+
+class SegmentedAlgorithmsTest : public testing::Test {
+public:
+    void SetUp() override {
+        for (int i = 0; i < 200; ++i) {
+            if (i % 3 == 0) {
+                list.push_front(i % 17);
+                std_list.push_front(i % 17);
+            } else {
+                list.push_back(i % 17);
+                std_list.push_back(i % 17);
+            }
+        }
+    }
+
+    unrolled_list<int, 6> list;
+    std::list<int> std_list;
+};
+
+TEST_F(SegmentedAlgorithmsTest, segments) {
+    std::vector<int> flattened;
+    size_t total = 0;
+    for (std::span<int> segment: list.segments()) {
+        ASSERT_FALSE(segment.empty());
+        ASSERT_LE(segment.size(), 6);
+        flattened.insert(flattened.end(), segment.begin(), segment.end());
+        total += segment.size();
+    }
+
+    ASSERT_EQ(total, list.size());
+    ASSERT_THAT(flattened, ::testing::ElementsAreArray(std_list));
+}
+
+TEST_F(SegmentedAlgorithmsTest, forEachAndAccumulate) {
+    int sum = 0;
+    unrolled::for_each(list, [&sum](int value) { sum += value; });
+
+    ASSERT_EQ(sum, std::accumulate(std_list.begin(), std_list.end(), 0));
+    ASSERT_EQ(unrolled::accumulate(list, 0), sum);
+    ASSERT_EQ(unrolled::accumulate(std::next(list.begin(), 7), std::next(list.begin(), 9), 0),
+              std::accumulate(std::next(std_list.begin(), 7), std::next(std_list.begin(), 9), 0));
+    ASSERT_EQ(unrolled::accumulate(list.begin(), list.begin(), 5), 5);
+}
+
+TEST_F(SegmentedAlgorithmsTest, findAndCount) {
+    for (int value: {0, 5, 16, 100}) {
+        auto found = unrolled::find(list, value);
+        auto expected = std::find(std_list.begin(), std_list.end(), value);
+        ASSERT_EQ(std::distance(list.begin(), found), std::distance(std_list.begin(), expected));
+        ASSERT_EQ(unrolled::count(list, value), std::count(std_list.begin(), std_list.end(), value));
+    }
+
+    auto first = std::next(list.begin(), 20);
+    auto found = unrolled::find_if(first, list.end(), [](int value) { return value > 15; });
+    ASSERT_EQ(*found, 16);
+    ASSERT_TRUE(unrolled::find(first, std::next(first, 3), 100) == std::next(first, 3));
+    ASSERT_EQ(unrolled::count_if(list.cbegin(), list.cend(), [](int value) { return value % 2 == 0; }),
+              std::count_if(std_list.begin(), std_list.end(), [](int value) { return value % 2 == 0; }));
+}
+
+TEST_F(SegmentedAlgorithmsTest, copyFillEqual) {
+    std::vector<int> copied(list.size());
+    unrolled::copy(list, copied.begin());
+    ASSERT_THAT(copied, ::testing::ElementsAreArray(std_list));
+    ASSERT_TRUE(unrolled::equal(list, std_list));
+
+    unrolled_list<int, 6> other(std_list.begin(), std_list.end());
+    ASSERT_TRUE(unrolled::equal(list, other));
+    ASSERT_TRUE(list == other);
+
+    unrolled::fill(std::next(list.begin(), 10), std::next(list.begin(), 50), -1);
+    std::fill(std::next(std_list.begin(), 10), std::next(std_list.begin(), 50), -1);
+    ASSERT_THAT(list, ::testing::ElementsAreArray(std_list));
+    ASSERT_FALSE(unrolled::equal(list, other));
+    ASSERT_FALSE(list == other);
+}
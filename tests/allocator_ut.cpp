@@ -1,8 +1,14 @@
 #include <unrolled_list.h>
+#include <unrolled_slab_allocator.h>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
 class NodeTag {};
 
 class SomeObj {
@@ -126,3 +132,269 @@ TEST_F(WorkWithAllocatorTest, CopyConstructorUsesAllocatorCorrectly) {
     ASSERT_GT(TestAllocator<NodeTag>::AllocationCount, 0);
     ASSERT_GT(TestAllocator<NodeTag>::ElementsAllocated, 0);
 }
+
+/*
+    Список используется как очередь: push_back в конец и pop_front из начала, поэтому ноды постоянно
+    освобождаются в начале и создаются в конце.
+
+    Ожидается, что:
+        1. После прогрева освободившиеся ноды переиспользуются и новых аллокаций Node нет
+        2. При нулевом лимите запасных нод каждая новая нода снова выделяется аллокатором
+        3. shrink_to_fit отдаёт все запасные ноды
+*/
+TEST_F(WorkWithAllocatorTest, spareNodesAreReused) {
+    unrolled_list<SomeObj, 4, TestAllocator<SomeObj>> list;
+    for (int i = 0; i < 100; ++i) {
+        list.emplace_back();
+        if (i >= 6) {
+            list.pop_front();
+        }
+    }
+
+    int allocations = TestAllocator<NodeTag>::AllocationCount;
+    for (int i = 0; i < 1000; ++i) {
+        list.emplace_back();
+        list.pop_front();
+    }
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, allocations);
+    ASSERT_EQ(list.size(), 6);
+
+    list.set_spare_node_limit(0);
+    ASSERT_EQ(list.spare_nodes(), 0);
+    for (int i = 0; i < 100; ++i) {
+        list.emplace_back();
+        list.pop_front();
+    }
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, allocations + 25);
+
+    list.set_spare_node_limit(8);
+    list.clear();
+    ASSERT_GE(list.spare_nodes(), 2);
+    list.shrink_to_fit();
+    ASSERT_EQ(list.spare_nodes(), 0);
+}
+
+/*
+    pmr::unrolled_list на monotonic_buffer_resource поверх null_memory_resource: любая аллокация мимо буфера
+    выбросит исключение. Проверяется, что все ноды и копия списка берутся из переданного ресурса
+*/
+TEST(PmrUnrolledList, monotonicBuffer) {
+    std::vector<std::byte> buffer(64 * 1024);
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+    pmr::unrolled_list<int, 16> list(&resource);
+    for (int i = 0; i < 1000; ++i) {
+        list.push_back(i);
+    }
+    list.erase(std::next(list.begin(), 100), std::next(list.begin(), 300));
+
+    pmr::unrolled_list<int, 16> copy(&resource);
+    copy = list;
+    ASSERT_EQ(copy.get_allocator().resource(), &resource);
+    ASSERT_TRUE(std::equal(copy.begin(), copy.end(), list.begin(), list.end()));
+
+    pmr::unrolled_list<int, 16> moved(std::move(list));
+    ASSERT_EQ(moved.get_allocator().resource(), &resource);
+    ASSERT_EQ(moved.size(), 800);
+}
+
+/*
+    Несколько потоков одновременно наполняют и опустошают свои списки на slab_allocator,
+    а последний список создаётся в одном потоке и разрушается в другом
+*/
+TEST(SlabAllocator, concurrentLists) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int round = 0; round < 20; ++round) {
+                unrolled::slab_unrolled_list<int, 8> list;
+                for (int i = 0; i < 2000; ++i) {
+                    if (i % 5 == 0 && !list.empty()) {
+                        list.pop_front();
+                    }
+                    list.push_back(t * 10000 + i);
+                }
+                ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    auto list = std::make_unique<unrolled::slab_unrolled_list<std::string, 4>>();
+    std::thread producer([&] {
+        for (int i = 0; i < 1000; ++i) {
+            list->push_back(std::to_string(i));
+        }
+    });
+    producer.join();
+    std::thread consumer([&] {
+        ASSERT_EQ(list->size(), 1000);
+        ASSERT_EQ(list->back(), "999");
+        list.reset();
+    });
+    consumer.join();
+}
+
+/*
+    Список с thread_local временем жизни создан раньше кэша блоков потока, поэтому разрушается после него
+    и возвращает свои ноды прямо в общий пул
+*/
+TEST(SlabAllocator, listOutlivesThreadCache) {
+    std::thread([] {
+        thread_local unrolled::slab_unrolled_list<int, 4> list;
+        for (int i = 0; i < 1000; ++i) {
+            list.push_back(i);
+        }
+    }).join();
+
+    unrolled::slab_unrolled_list<int, 4> list;
+    for (int i = 0; i < 1000; ++i) {
+        list.push_back(i);
+    }
+    ASSERT_EQ(list.size(), 1000);
+}
+
+/*
+    reserve выделяет все ноды заранее, после чего заполнение списка до capacity() не вызывает аллокатор
+*/
+TEST_F(WorkWithAllocatorTest, reservePreallocatesNodes) {
+    unrolled_list<SomeObj, 5, TestAllocator<SomeObj>> list;
+    list.reserve(23);
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, 5);
+    ASSERT_EQ(list.capacity(), 25);
+    ASSERT_EQ(list.spare_nodes(), 5);
+
+    for (int i = 0; i < 25; ++i) {
+        list.emplace_back();
+    }
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, 5);
+    ASSERT_EQ(list.capacity(), 25);
+
+    list.reserve(10);
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, 5);
+
+    list.emplace_back();
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount, 6);
+
+    list.clear();
+    list.shrink_to_fit();
+    ASSERT_EQ(list.capacity(), 0);
+    ASSERT_THROW(list.reserve(list.max_size() + 1), std::length_error);
+}
+
+/*
+    sort и merge перекладывают элементы через запасные ноды, но не освобождают ноды, выделенные reserve
+*/
+TEST_F(WorkWithAllocatorTest, reserveSurvivesSort) {
+    unrolled_list<int, 8> list;
+    unrolled_list<int, 8> other;
+    for (int i = 0; i < 100; ++i) {
+        list.push_back(100 - i);
+        other.push_back(i);
+    }
+    list.reserve(1000);
+
+    list.sort();
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+    ASSERT_GE(list.capacity(), 1000);
+
+    list.merge(other);
+    ASSERT_EQ(list.size(), 200);
+    ASSERT_GE(list.capacity(), 1000);
+
+    list.set_spare_node_limit(0);
+    ASSERT_GE(list.capacity(), 1000);
+
+    list.shrink_to_fit();
+    ASSERT_EQ(list.spare_nodes(), 0);
+}
+
+/*
+    splice между списками на разных memory_resource не может перевесить ноды и перемещает элементы по одному
+*/
+TEST(PmrUnrolledList, spliceBetweenResources) {
+    std::pmr::monotonic_buffer_resource first_resource;
+    std::pmr::monotonic_buffer_resource second_resource;
+    pmr::unrolled_list<int, 4> list(&first_resource);
+    pmr::unrolled_list<int, 4> other(&second_resource);
+    for (int i = 0; i < 20; ++i) {
+        list.push_back(i);
+        other.push_back(100 + i);
+    }
+
+    list.splice(std::next(list.begin(), 10), other, std::next(other.begin(), 3), std::next(other.begin(), 9));
+    ASSERT_EQ(list.size(), 26);
+    ASSERT_EQ(other.size(), 14);
+    ASSERT_EQ(list[10], 103);
+    ASSERT_EQ(list[16], 10);
+
+    list.splice(list.end(), other);
+    ASSERT_EQ(list.size(), 40);
+    ASSERT_TRUE(other.empty());
+    ASSERT_EQ(list.back(), 119);
+}
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocated = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override {
+        allocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/*
+    Перемещение между списками на разных ресурсах переносит элементы в ноды нового ресурса,
+    а на одном ресурсе забирает ноды без аллокаций. К концу теста каждый ресурс получает обратно всю свою память
+*/
+TEST(PmrUnrolledList, moveBetweenResources) {
+    CountingResource first_resource;
+    CountingResource second_resource;
+    {
+        pmr::unrolled_list<std::string, 4> list(&first_resource);
+        for (int i = 0; i < 50; ++i) {
+            list.push_back(std::to_string(i));
+        }
+        size_t first_allocated = first_resource.allocated;
+
+        pmr::unrolled_list<std::string, 4> moved(std::move(list), &second_resource);
+        ASSERT_EQ(moved.get_allocator().resource(), &second_resource);
+        ASSERT_EQ(moved.size(), 50);
+        ASSERT_EQ(moved.back(), "49");
+        ASSERT_TRUE(list.empty());
+        ASSERT_GT(second_resource.allocated, 0);
+        ASSERT_LE(first_resource.allocated, first_allocated);
+
+        size_t second_allocated = second_resource.allocated;
+        pmr::unrolled_list<std::string, 4> stolen(std::move(moved), &second_resource);
+        ASSERT_EQ(second_resource.allocated, second_allocated);
+        ASSERT_EQ(stolen.size(), 50);
+
+        list = std::move(stolen);
+        ASSERT_EQ(list.get_allocator().resource(), &first_resource);
+        ASSERT_EQ(list.size(), 50);
+        ASSERT_EQ(list.front(), "0");
+        ASSERT_TRUE(stolen.empty());
+
+        pmr::unrolled_list<std::string, 4> other(&second_resource);
+        other.push_back("x");
+        other = std::move(list);
+        ASSERT_EQ(other.size(), 50);
+        ASSERT_EQ(other.get_allocator().resource(), &second_resource);
+    }
+    ASSERT_EQ(first_resource.allocated, 0);
+    ASSERT_EQ(second_resource.allocated, 0);
+}
@@ -4,6 +4,7 @@
 #include <gmock/gmock.h>
 
 #include <list>
+#include <vector>
 
 class NodeTag {};
 
@@ -28,6 +29,23 @@ public:
     }
 };
 
+// Перемещения нет, поэтому элементы при сдвигах копируются, и копирование может выбросить исключение
+struct CopyOnly {
+    static inline bool Fail = false;
+
+    CopyOnly(int value)
+        : Value(value) {}
+
+    CopyOnly(const CopyOnly& other)
+        : Value(other.Value) {
+        if (Fail) {
+            throw std::runtime_error("");
+        }
+    }
+
+    int Value;
+};
+
 struct Bad {};
 struct Good {
     std::string Name;
@@ -201,4 +219,85 @@ TEST_F(ExceptionSafetyTest, failsAtInsert) {
     ASSERT_EQ(unrolled_list.size(), 2);
     ASSERT_EQ(unrolled_list.begin()->Name, "first");
     ASSERT_EQ((++unrolled_list.begin())->Name, "second");
-}
\ No newline at end of file
+}
+/*
+    Тест проверяет, что вставка диапазона в середину списка, в котором копирование третьего элемента
+    выбрасывает исключение, не меняет список и освобождает все выделенные под вставку Node
+*/
+TEST_F(ExceptionSafetyTest, failsAtInsertRange) {
+    std::list<SomeObj> std_list;
+    for (int i = 0; i < 5; ++i) {
+        std_list.push_back(SomeObj{});
+    }
+
+    using unrolled_list_type = unrolled_list<SomeObj, 4, TestAllocator<SomeObj>>;
+    unrolled_list_type ul;
+    for (int i = 0; i < 6; ++i) {
+        ul.push_back(SomeObj{});
+    }
+    SomeObj::DestructorCalled = 0;
+    int allocations = TestAllocator<NodeTag>::AllocationCount;
+
+    ASSERT_ANY_THROW(ul.insert(std::next(ul.begin(), 3), std_list.begin(), std_list.end()));
+
+    ASSERT_EQ(ul.size(), 6);
+    ASSERT_EQ(std::distance(ul.begin(), ul.end()), 6);
+    ASSERT_EQ(SomeObj::DestructorCalled, 2);
+    ASSERT_EQ(TestAllocator<NodeTag>::AllocationCount - allocations, TestAllocator<NodeTag>::DeallocationCount);
+}
+
+/*
+    Элементы CopyOnly не сдвигаются внутри ноды: при вставке и удалении в середине ноды
+    хвост ноды копируется в новую ноду.
+
+    Тест проверяет:
+        1. Вставка, удаление и compact выбрасывают исключение, если копирование не удалось
+        2. Список после этого не меняется
+        3. Без исключений те же операции работают, а operator[] видит все изменения
+*/
+TEST_F(ExceptionSafetyTest, failsAtRelocation) {
+    unrolled_list<CopyOnly, 4> ul;
+    std::vector<int> expected;
+    for (int i = 0; i < 8; ++i) {
+        ul.emplace_back(i);
+        expected.push_back(i);
+    }
+    auto values = [&ul] {
+        std::vector<int> result;
+        for (const auto& element : ul) {
+            result.push_back(element.Value);
+        }
+        return result;
+    };
+    ASSERT_EQ(ul[7].Value, 7);
+
+    CopyOnly::Fail = true;
+    ASSERT_ANY_THROW(ul.emplace(std::next(ul.begin(), 2), 100));
+    ASSERT_ANY_THROW(ul.erase(std::next(ul.begin(), 5)));
+    ASSERT_ANY_THROW(ul.compact());
+    CopyOnly::Fail = false;
+
+    ASSERT_EQ(ul.size(), 8);
+    ASSERT_EQ(values(), expected);
+
+    ul.emplace(std::next(ul.begin(), 2), 100);
+    expected.insert(expected.begin() + 2, 100);
+    ul.erase(std::next(ul.begin(), 6));
+    expected.erase(expected.begin() + 6);
+    ul.emplace(ul.begin(), -1);
+    expected.insert(expected.begin(), -1);
+    ul.emplace(std::next(ul.begin(), 4), 100);
+    expected.insert(expected.begin() + 4, 100);
+
+    ASSERT_EQ(ul.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(ul[i].Value, expected[i]);
+    }
+
+    ul.compact();
+    ASSERT_EQ(values(), expected);
+
+    ASSERT_EQ(ul.unique([](const CopyOnly& a, const CopyOnly& b) { return a.Value == b.Value; }), 1);
+    expected.erase(expected.begin() + 4);
+    ASSERT_EQ(values(), expected);
+}
@@ -0,0 +1,127 @@
+#include <unrolled_io.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Тесты сериализации из unrolled_io.h: запись и чтение через потоки и файловые дескрипторы,
+    чтение в список с другим размером ноды, кодек для строк и ошибки формата
+*/
+
+namespace {
+
+struct Point {
+    std::int32_t x;
+    double y;
+
+    bool operator==(const Point &) const = default;
+};
+
+// Строка как длина и байты
+struct StringCodec {
+    void encode(std::ostream &os, const std::string &value) {
+        std::uint32_t size = static_cast<std::uint32_t>(value.size());
+        os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        os.write(value.data(), size);
+    }
+
+    std::string decode(std::istream &is) {
+        std::uint32_t size = 0;
+        is.read(reinterpret_cast<char *>(&size), sizeof(size));
+        std::string value(is ? size : 0, '\0');
+        is.read(value.data(), static_cast<std::streamsize>(value.size()));
+        return value;
+    }
+};
+
+} // namespace
+
+TEST(UnrolledIo, streamRoundTrip) {
+    std::vector<int> values(10000);
+    std::iota(values.begin(), values.end(), -5000);
+    unrolled_list<int, 7> list(values.begin(), values.end());
+
+    std::stringstream stream;
+    unrolled::write(stream, list);
+    ASSERT_EQ(stream.str().size(), sizeof(unrolled::stream_header) + values.size() * sizeof(int));
+
+    // Размер ноды не входит в формат
+    unrolled_list<int, 64> other{1, 2, 3};
+    unrolled::read(stream, other);
+    ASSERT_EQ(std::vector<int>(other.begin(), other.end()), values);
+
+    unrolled_list<Point> points{{1, 0.5}, {2, 1.5}, {3, 2.5}};
+    unrolled_list<Point> empty;
+    std::stringstream point_stream;
+    unrolled::write(point_stream, points);
+    unrolled::write(point_stream, empty);
+    unrolled_list<Point> read_points;
+    unrolled::read(point_stream, read_points);
+    ASSERT_EQ(read_points, points);
+    unrolled::read(point_stream, read_points);
+    ASSERT_TRUE(read_points.empty());
+}
+
+TEST(UnrolledIo, codec) {
+    unrolled_list<std::string, 3> words{"alpha", "", "a much longer string that does not fit in SSO", "z"};
+    std::stringstream stream;
+    unrolled::write(stream, words, StringCodec{});
+
+    unrolled_list<std::string, 5> read_words{"stale"};
+    unrolled::read(stream, read_words, StringCodec{});
+    ASSERT_THAT(std::vector<std::string>(read_words.begin(), read_words.end()),
+                ::testing::ElementsAreArray(std::vector<std::string>(words.begin(), words.end())));
+}
+
+TEST(UnrolledIo, formatErrorsKeepList) {
+    unrolled_list<int, 4> list{1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::stringstream stream;
+    unrolled::write(stream, list);
+    const std::string data = stream.str();
+
+    unrolled_list<int, 4> target{42};
+    std::stringstream truncated(data.substr(0, data.size() - 1));
+    ASSERT_THROW(unrolled::read(truncated, target), std::runtime_error);
+    ASSERT_THAT(std::vector<int>(target.begin(), target.end()), ::testing::ElementsAre(42));
+
+    unrolled_list<std::int64_t, 4> wrong_size;
+    std::stringstream again(data);
+    ASSERT_THROW(unrolled::read(again, wrong_size), std::runtime_error);
+
+    unrolled_list<std::string> strings;
+    std::stringstream raw(data);
+    ASSERT_THROW(unrolled::read(raw, strings, StringCodec{}), std::runtime_error);
+
+    std::stringstream garbage("not a list at all, just some text");
+    ASSERT_THROW(unrolled::read(garbage, target), std::runtime_error);
+    ASSERT_EQ(target.size(), 1);
+}
+
+#ifdef UNROLLED_IO_HAS_FD
+TEST(UnrolledIo, fileDescriptor) {
+    std::vector<std::int64_t> values(100000);
+    std::iota(values.begin(), values.end(), 0);
+    unrolled_list<std::int64_t, 100> list(values.begin(), values.end());
+
+    std::FILE *file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    int fd = fileno(file);
+    unrolled::write(fd, list);
+    ASSERT_EQ(::lseek(fd, 0, SEEK_SET), 0);
+
+    unrolled_list<std::int64_t, 33> other;
+    unrolled::read(fd, other);
+    ASSERT_EQ(std::vector<std::int64_t>(other.begin(), other.end()), values);
+    ASSERT_THROW(unrolled::read(fd, other), std::runtime_error);
+    ASSERT_EQ(other.size(), values.size());
+    std::fclose(file);
+}
+#endif
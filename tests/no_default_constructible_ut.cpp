@@ -38,3 +38,30 @@ TEST(NoDefaultConstructible, insertWorksCorrectly) {
         ++expected_val;
     }
 }
+
+TEST(NoDefaultConstructible, popFrontWorksCorrectly) {
+    unrolled_list<NoDefaultConstructible, 4> unrolled_list;
+    for (int i = 0; i < 10; ++i) {
+        unrolled_list.push_back(NoDefaultConstructible(i));
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        unrolled_list.pop_front();
+        ASSERT_EQ(unrolled_list.size(), 9 - i);
+    }
+    ASSERT_TRUE(unrolled_list.empty());
+}
+
+TEST(NoDefaultConstructible, eraseWorksCorrectly) {
+    unrolled_list<NoDefaultConstructible, 4> unrolled_list;
+    for (int i = 0; i < 20; ++i) {
+        unrolled_list.push_back(NoDefaultConstructible(i));
+    }
+
+    auto it = unrolled_list.erase(std::next(unrolled_list.begin(), 5));
+    it = unrolled_list.erase(it, std::next(it, 7));
+    unrolled_list.erase(unrolled_list.begin());
+
+    ASSERT_EQ(unrolled_list.size(), 11);
+    ASSERT_EQ(std::distance(unrolled_list.begin(), unrolled_list.end()), 11);
+}
@@ -0,0 +1,120 @@
+#include <unrolled_parallel.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+/*
+    Тесты перегрузок алгоритмов с политикой выполнения из unrolled_parallel.h.
+    Маленький grain заставляет разбить список на много кусков, а ноды разной заполненности
+    проверяют, что границы кусков проходят только по границам нод
+*/
+
+class ParallelAlgorithmsTest : public testing::Test {
+public:
+    void SetUp() override {
+        for (int i = 0; i < 100000; ++i) {
+            list.push_back(i % 1000);
+        }
+        for (int i = 0; i < 500; ++i) {
+            list.erase(list.iterator_at((i * 7919) % list.size()));
+        }
+        expected.assign(list.begin(), list.end());
+    }
+
+    unrolled::execution::parallel_policy policy{4, 1000};
+    unrolled_list<int, 16> list;
+    std::vector<int> expected;
+};
+
+TEST_F(ParallelAlgorithmsTest, forEach) {
+    unrolled::for_each(policy, list, [](int &value) { value *= 2; });
+    for (int &value: expected) {
+        value *= 2;
+    }
+    ASSERT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+
+    unrolled::for_each(unrolled::execution::seq, list, [](int &value) { value /= 2; });
+    ASSERT_EQ(list.front(), expected.front() / 2);
+}
+
+TEST_F(ParallelAlgorithmsTest, transform) {
+    std::vector<long long> squares(list.size());
+    auto end = unrolled::transform(policy, list, squares.begin(), [](int value) { return 1LL * value * value; });
+    ASSERT_EQ(end, squares.end());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(squares[i], 1LL * expected[i] * expected[i]);
+    }
+
+    unrolled_list<int, 7> negated(list.size());
+    unrolled::transform(policy, list, negated.begin(), [](int value) { return -value; });
+    ASSERT_EQ(negated.back(), -expected.back());
+    ASSERT_EQ(unrolled::reduce(policy, negated, 0LL), -std::accumulate(expected.begin(), expected.end(), 0LL));
+}
+
+TEST_F(ParallelAlgorithmsTest, reduceAndCountIf) {
+    long long sum = std::accumulate(expected.begin(), expected.end(), 0LL);
+    ASSERT_EQ(unrolled::reduce(policy, list, 0LL), sum);
+    ASSERT_EQ(unrolled::reduce(unrolled::execution::seq, list, 0LL), sum);
+    ASSERT_EQ(unrolled::reduce(policy, list, 0, [](int a, int b) { return std::max(a, b); }), 999);
+
+    auto odd = [](int value) { return value % 2 == 1; };
+    std::ptrdiff_t count = std::count_if(expected.begin(), expected.end(), odd);
+    ASSERT_EQ(unrolled::count_if(policy, list, odd), count);
+    ASSERT_EQ(unrolled::count_if(unrolled::execution::par, list, odd), count);
+}
+
+TEST_F(ParallelAlgorithmsTest, emptyListAndExceptions) {
+    unrolled_list<int, 16> empty;
+    ASSERT_EQ(unrolled::reduce(policy, empty, 5), 5);
+    ASSERT_EQ(unrolled::count_if(policy, empty, [](int) { return true; }), 0);
+
+    ASSERT_THROW(unrolled::for_each(policy, list, [](int value) {
+        if (value == 999) {
+            throw std::runtime_error("999");
+        }
+    }), std::runtime_error);
+}
+
+TEST_F(ParallelAlgorithmsTest, nestedCalls) {
+    // Потоки пула переиспользуются между вызовами, а вложенный вызов из f не ждёт занятых потоков
+    long long sum = std::accumulate(expected.begin(), expected.end(), 0LL);
+    std::atomic<long long> nested{0};
+    unrolled_list<int, 16> small(list.begin(), list.iterator_at(5000));
+    unrolled::for_each(unrolled::execution::parallel_policy{4, 10}, small, [&](int value) {
+        if (value == 0) {
+            nested += unrolled::reduce(policy, list, 0LL);
+        }
+    });
+    long long zeros = std::count(small.begin(), small.end(), 0);
+    ASSERT_EQ(nested.load(), zeros * sum);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(unrolled::reduce(policy, list, 0LL), sum);
+    }
+}
+
+TEST_F(ParallelAlgorithmsTest, sort) {
+    unrolled_list<int, 16> copy(list);
+    std::stable_sort(expected.begin(), expected.end(), std::greater<>());
+    unrolled::sort(policy, list, std::greater<>());
+    ASSERT_EQ(list.size(), expected.size());
+    ASSERT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+    ASSERT_EQ(list[12345], expected[12345]);
+
+    unrolled::sort(unrolled::execution::seq, copy, std::greater<>());
+    ASSERT_EQ(copy, list);
+
+    // Устойчивость: элементы с равными ключами сохраняют исходный порядок
+    unrolled_list<std::pair<int, int>, 8> pairs;
+    for (int i = 0; i < 50000; ++i) {
+        pairs.emplace_back(i % 10, i);
+    }
+    unrolled::sort(unrolled::execution::parallel_policy{3, 500}, pairs,
+                   [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    ASSERT_TRUE(std::is_sorted(pairs.begin(), pairs.end()));
+}
@@ -0,0 +1,145 @@
+#include <unrolled_simd.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+/*
+    Тесты векторизованных алгоритмов из unrolled_simd.h.
+    Каждый тест прогоняется на всех наборах инструкций, которые поддерживает процессор (scalar, sse2, avx2),
+    а результаты сравниваются с алгоритмами стандартной библиотеки на std::vector с теми же элементами.
+    Размер ноды 13 выбран так, чтобы в нодах оставались хвосты, не кратные ширине регистра
+*/
+
+template<typename T>
+class SimdTest : public testing::Test {
+public:
+    void SetUp() override {
+        for (int i = 0; i < 500; ++i) {
+            T value = static_cast<T>((i * 37) % 101 - 50);
+            if (i % 4 == 0) {
+                list.push_front(value);
+                expected.insert(expected.begin(), value);
+            } else {
+                list.push_back(value);
+                expected.push_back(value);
+            }
+        }
+        // Ноды разной заполненности
+        for (int i = 0; i < 60; ++i) {
+            size_t pos = (i * 7919) % list.size();
+            list.erase(list.iterator_at(pos));
+            expected.erase(expected.begin() + pos);
+        }
+    }
+
+    void TearDown() override {
+        unrolled::simd::use_isa(unrolled::simd::isa::avx2);
+    }
+
+    static std::vector<unrolled::simd::isa> isas() {
+        std::vector<unrolled::simd::isa> result;
+        for (auto isa: {unrolled::simd::isa::scalar, unrolled::simd::isa::sse2, unrolled::simd::isa::avx2}) {
+            if (unrolled::simd::use_isa(isa) == isa) {
+                result.push_back(isa);
+            }
+        }
+        return result;
+    }
+
+    unrolled_list<T, 13> list;
+    std::vector<T> expected;
+};
+
+using SimdTypes = testing::Types<std::int32_t, float, double>;
+TYPED_TEST_SUITE(SimdTest, SimdTypes);
+
+TYPED_TEST(SimdTest, find) {
+    for (auto isa: this->isas()) {
+        unrolled::simd::use_isa(isa);
+        for (int v = -52; v <= 52; ++v) {
+            TypeParam value = static_cast<TypeParam>(v);
+            auto expected_it = std::find(this->expected.begin(), this->expected.end(), value);
+            auto it = unrolled::simd::find(std::as_const(this->list), value);
+            ASSERT_EQ(std::distance(this->list.cbegin(), it), expected_it - this->expected.begin());
+        }
+    }
+}
+
+TYPED_TEST(SimdTest, count) {
+    for (auto isa: this->isas()) {
+        unrolled::simd::use_isa(isa);
+        for (int v = -52; v <= 52; ++v) {
+            TypeParam value = static_cast<TypeParam>(v);
+            ASSERT_EQ(unrolled::simd::count(this->list, value),
+                      std::count(this->expected.begin(), this->expected.end(), value));
+        }
+    }
+}
+
+TYPED_TEST(SimdTest, minMax) {
+    for (auto isa: this->isas()) {
+        unrolled::simd::use_isa(isa);
+        ASSERT_EQ(unrolled::simd::min(this->list), *std::min_element(this->expected.begin(), this->expected.end()));
+        ASSERT_EQ(unrolled::simd::max(this->list), *std::max_element(this->expected.begin(), this->expected.end()));
+
+        unrolled_list<TypeParam, 13> single;
+        single.push_back(7);
+        ASSERT_EQ(unrolled::simd::minmax(single), std::make_pair(TypeParam(7), TypeParam(7)));
+    }
+}
+
+TYPED_TEST(SimdTest, sum) {
+    for (auto isa: this->isas()) {
+        unrolled::simd::use_isa(isa);
+        // Все значения целые и небольшие, поэтому сумма float/double тоже точная
+        unrolled::simd::sum_t<TypeParam> expected_sum =
+            std::accumulate(this->expected.begin(), this->expected.end(), unrolled::simd::sum_t<TypeParam>(0));
+        ASSERT_EQ(unrolled::simd::sum(this->list), expected_sum);
+    }
+}
+
+TYPED_TEST(SimdTest, filter) {
+    using unrolled::simd::compare;
+    for (auto isa: this->isas()) {
+        unrolled::simd::use_isa(isa);
+        for (compare op: {compare::equal, compare::not_equal, compare::less, compare::greater}) {
+            TypeParam value = 10;
+            std::vector<TypeParam> result;
+            unrolled::simd::filter(this->list, op, value, std::back_inserter(result));
+
+            std::vector<TypeParam> expected_result;
+            std::copy_if(this->expected.begin(), this->expected.end(), std::back_inserter(expected_result),
+                         [&](TypeParam e) {
+                             switch (op) {
+                                 case compare::equal:
+                                     return e == value;
+                                 case compare::not_equal:
+                                     return e != value;
+                                 case compare::less:
+                                     return e < value;
+                                 default:
+                                     return e > value;
+                             }
+                         });
+            ASSERT_THAT(result, testing::ElementsAreArray(expected_result));
+        }
+    }
+}
+
+TEST(Simd, emptyList) {
+    unrolled_list<std::int32_t> list;
+    ASSERT_EQ(unrolled::simd::find(list, 1), list.end());
+    ASSERT_EQ(unrolled::simd::count(list, 1), 0);
+    ASSERT_EQ(unrolled::simd::sum(list), 0);
+}
+
+TEST(Simd, sumDoesNotOverflow) {
+    unrolled_list<std::int32_t, 64> list(1000, INT32_MAX);
+    ASSERT_EQ(unrolled::simd::sum(list), std::int64_t(1000) * INT32_MAX);
+}
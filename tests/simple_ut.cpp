@@ -3,8 +3,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <list>
+#include <memory>
+#include <random>
+#include <string>
 
 /*
     В данном файле представлен ряд тестов, где используются (вместе, раздельно и по-очереди):
@@ -80,6 +85,115 @@ TEST(UnrolledLinkedList, insertAndPushMixed) {
     ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
 }
 
+TEST(UnrolledLinkedList, insertIntoFullNodes) {
+    std::list<int> std_list;
+    unrolled_list<int, 4> unrolled_list;
+
+    for (int i = 0; i < 500; ++i) {
+        auto std_it = std_list.begin();
+        auto unrolled_it = unrolled_list.begin();
+        std::advance(std_it, (i * 7) % (std_list.size() + 1));
+        std::advance(unrolled_it, (i * 7) % (std_list.size() + 1));
+        std_it = std_list.insert(std_it, i);
+        auto inserted = unrolled_list.insert(unrolled_it, i);
+        ASSERT_EQ(*inserted, i);
+    }
+
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+}
+
+TEST(UnrolledLinkedList, eraseChurn) {
+    std::list<int> std_list;
+    unrolled_list<int, 8> unrolled_list;
+
+    for (int i = 0; i < 2000; ++i) {
+        std_list.push_back(i);
+        unrolled_list.push_back(i);
+    }
+
+    for (int i = 0; i < 1500; ++i) {
+        size_t pos = (i * 13) % std_list.size();
+        auto std_it = std::next(std_list.begin(), pos);
+        auto unrolled_it = std::next(unrolled_list.begin(), pos);
+        std_it = std_list.erase(std_it);
+        unrolled_it = unrolled_list.erase(unrolled_it);
+        if (std_it == std_list.end()) {
+            ASSERT_TRUE(unrolled_it == unrolled_list.end());
+        } else {
+            ASSERT_EQ(*unrolled_it, *std_it);
+        }
+    }
+
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+}
+
+TEST(UnrolledLinkedList, eraseRange) {
+    std::list<int> std_list;
+    unrolled_list<int, 5> unrolled_list;
+
+    for (int i = 0; i < 100; ++i) {
+        std_list.push_back(i);
+        unrolled_list.push_back(i);
+    }
+
+    auto std_it = std_list.erase(std::next(std_list.begin(), 13), std::next(std_list.begin(), 71));
+    auto unrolled_it = unrolled_list.erase(std::next(unrolled_list.begin(), 13), std::next(unrolled_list.begin(), 71));
+
+    ASSERT_EQ(*unrolled_it, *std_it);
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+
+    unrolled_it = unrolled_list.erase(unrolled_list.begin(), unrolled_list.end());
+    ASSERT_TRUE(unrolled_it == unrolled_list.end());
+    ASSERT_TRUE(unrolled_list.empty());
+}
+
+TEST(UnrolledLinkedList, insertRange) {
+    std::list<int> std_list;
+    unrolled_list<int, 8> unrolled_list;
+
+    for (int i = 0; i < 50; ++i) {
+        std_list.push_back(i);
+        unrolled_list.push_back(i);
+    }
+
+    std::vector<int> values(100);
+    for (int i = 0; i < 100; ++i) {
+        values[i] = 1000 + i;
+    }
+
+    for (size_t pos: {0, 13, 16, 75, 250}) {
+        pos = std::min(pos, std_list.size());
+        std_list.insert(std::next(std_list.begin(), pos), values.begin(), values.end());
+        unrolled_list.insert(std::next(unrolled_list.begin(), pos), values.begin(), values.end());
+    }
+    unrolled_list.insert(unrolled_list.end(), std_list.begin(), std_list.end());
+    std_list.insert(std_list.end(), std_list.begin(), std_list.end());
+
+    ASSERT_EQ(unrolled_list.size(), std_list.size());
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+}
+
+TEST(UnrolledLinkedList, insertCopies) {
+    std::list<std::string> std_list(7, "a");
+    unrolled_list<std::string, 4> unrolled_list(7, "a");
+
+    auto std_it = std_list.insert(std::next(std_list.begin(), 3), 10, "b");
+    auto unrolled_it = unrolled_list.insert(std::next(unrolled_list.begin(), 3), 10, "b");
+
+    ASSERT_EQ(std::distance(unrolled_list.begin(), unrolled_it), std::distance(std_list.begin(), std_it));
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+
+    unrolled_it = unrolled_list.insert(unrolled_list.begin(), 0, "c");
+    ASSERT_TRUE(unrolled_it == unrolled_list.begin());
+}
+
+TEST(UnrolledLinkedList, sizeConstructor) {
+    unrolled_list<std::string, 4> unrolled_list(9);
+
+    ASSERT_EQ(unrolled_list.size(), 9);
+    ASSERT_THAT(unrolled_list, ::testing::Each(std::string()));
+}
+
 TEST(UnrolledLinkedList, popFrontBack) {
     std::list<int> std_list;
     unrolled_list<int> unrolled_list;
@@ -109,6 +223,343 @@ TEST(UnrolledLinkedList, popFrontBack) {
     ASSERT_TRUE(unrolled_list.empty());
 }
 
+TEST(UnrolledLinkedList, queueUsage) {
+    std::list<int> std_list;
+    unrolled_list<int, 4> unrolled_list;
+
+    for (int i = 0; i < 1000; ++i) {
+        std_list.push_back(i);
+        unrolled_list.push_back(i);
+        if (i % 3 == 0) {
+            std_list.pop_front();
+            unrolled_list.pop_front();
+        }
+        if (i % 7 == 0) {
+            std_list.push_front(-i);
+            unrolled_list.push_front(-i);
+        }
+    }
+
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_EQ(unrolled_list.size(), std_list.size());
+}
+
+struct Counted {
+    static inline int Copies = 0;
+    static inline int Moves = 0;
+
+    Counted(int a, std::string b) : a(a), b(std::move(b)) {}
+    Counted(const Counted &other) : a(other.a), b(other.b) { ++Copies; }
+    Counted(Counted &&other) noexcept : a(other.a), b(std::move(other.b)) { ++Moves; }
+
+    int a;
+    std::string b;
+};
+
+struct Relocatable {
+    explicit Relocatable(int value) : value(std::make_unique<int>(value)) {}
+
+    std::unique_ptr<int> value;
+};
+
+template<>
+struct is_trivially_relocatable<Relocatable> : std::true_type {
+};
+
+TEST(UnrolledLinkedList, triviallyRelocatable) {
+    std::list<int> std_list;
+    unrolled_list<Relocatable, 6> unrolled_list;
+
+    for (int i = 0; i < 300; ++i) {
+        size_t pos = (i * 11) % (std_list.size() + 1);
+        std_list.insert(std::next(std_list.begin(), pos), i);
+        unrolled_list.emplace(std::next(unrolled_list.begin(), pos), i);
+        if (i % 4 == 0) {
+            std_list.push_front(-i);
+            unrolled_list.emplace_front(-i);
+        }
+    }
+    for (int i = 0; i < 200; ++i) {
+        size_t pos = (i * 7) % std_list.size();
+        std_list.erase(std::next(std_list.begin(), pos));
+        unrolled_list.erase(std::next(unrolled_list.begin(), pos));
+    }
+
+    std::vector<int> values;
+    for (const auto &element: unrolled_list) {
+        values.push_back(*element.value);
+    }
+    ASSERT_THAT(values, ::testing::ElementsAreArray(std_list));
+}
+
+TEST(UnrolledLinkedList, emplace) {
+    unrolled_list<Counted, 4> unrolled_list;
+    for (int i = 0; i < 6; ++i) {
+        unrolled_list.emplace_back(i, "back");
+    }
+    Counted::Moves = 0;
+
+    Counted &front = unrolled_list.emplace_front(-1, "front");
+    Counted &back = unrolled_list.emplace_back(6, "back");
+    auto it = unrolled_list.emplace(std::next(unrolled_list.begin(), 2), 100, "middle");
+
+    ASSERT_EQ(front.a, -1);
+    ASSERT_EQ(back.a, 6);
+    ASSERT_EQ(it->a, 100);
+    ASSERT_EQ(it->b, "middle");
+    ASSERT_EQ(Counted::Copies, 0);
+    ASSERT_EQ(unrolled_list.size(), 9);
+    ASSERT_EQ(unrolled_list.front().b, "front");
+    ASSERT_EQ(unrolled_list.back().b, "back");
+
+    it = unrolled_list.emplace(unrolled_list.end(), 7, "end");
+    ASSERT_EQ(it->a, 7);
+    ASSERT_EQ(&*it, &unrolled_list.back());
+}
+
+TEST(UnrolledLinkedList, eraseDoesNotCopy) {
+    unrolled_list<Counted, 8> unrolled_list;
+    for (int i = 0; i < 64; ++i) {
+        unrolled_list.emplace_back(i, std::to_string(i));
+    }
+    Counted::Copies = 0;
+
+    for (int i = 0; i < 40; ++i) {
+        unrolled_list.erase(std::next(unrolled_list.begin(), (i * 5) % unrolled_list.size()));
+    }
+    for (int i = 0; i < 10; ++i) {
+        unrolled_list.pop_front();
+    }
+
+    ASSERT_EQ(Counted::Copies, 0);
+    ASSERT_EQ(unrolled_list.size(), 14);
+    for (const auto &value: unrolled_list) {
+        ASSERT_EQ(value.b, std::to_string(value.a));
+    }
+}
+
+TEST(UnrolledLinkedList, pushOwnElement) {
+    unrolled_list<std::string, 4> unrolled_list;
+    unrolled_list.push_back("first");
+    unrolled_list.push_back("second");
+    unrolled_list.push_back("third");
+    unrolled_list.pop_front();
+
+    unrolled_list.push_back(unrolled_list.front());
+    unrolled_list.push_front(unrolled_list.back());
+    unrolled_list.insert(std::next(unrolled_list.begin()), unrolled_list.back());
+
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAre("second", "second", "second", "third", "second"));
+
+    unrolled_list.insert(unrolled_list.end(), unrolled_list.front());
+    unrolled_list.insert(unrolled_list.end(), unrolled_list.back());
+
+    ASSERT_THAT(unrolled_list,
+                ::testing::ElementsAre("second", "second", "second", "third", "second", "second", "second"));
+}
+
+/*
+    Строки длиннее буфера короткой строки, поэтому перемещенный аргумент стал бы пустым.
+    Единственная нода сдвигается при каждой вставке
+*/
+TEST(UnrolledLinkedList, emplaceOwnElement) {
+    const std::string value(30, 'b');
+    unrolled_list<std::string, 4> unrolled_list;
+    unrolled_list.push_front(value);
+
+    unrolled_list.insert(unrolled_list.end(), unrolled_list.front());
+    unrolled_list.emplace_back(unrolled_list.front());
+    unrolled_list.emplace_front(unrolled_list.back());
+    unrolled_list.pop_back();
+    unrolled_list.emplace(std::next(unrolled_list.begin()), unrolled_list.back());
+
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAre(value, value, value, value));
+}
+
+TEST(UnrolledLinkedList, indexedAccess) {
+    std::vector<int> vector;
+    unrolled_list<int, 6> unrolled_list;
+
+    for (int i = 0; i < 2000; ++i) {
+        switch (i % 5) {
+            case 0:
+                vector.insert(vector.begin(), i);
+                unrolled_list.push_front(i);
+                break;
+            case 1:
+                vector.erase(vector.begin());
+                unrolled_list.pop_front();
+                break;
+            case 2:
+                vector.insert(vector.begin() + vector.size() / 3, i);
+                unrolled_list.insert(unrolled_list.iterator_at(unrolled_list.size() / 3), i);
+                break;
+            default:
+                vector.push_back(i);
+                unrolled_list.push_back(i);
+        }
+        if (vector.empty()) {
+            continue;
+        }
+        size_t pos = (i * 31) % vector.size();
+        ASSERT_EQ(unrolled_list[pos], vector[pos]);
+        ASSERT_EQ(unrolled_list[0], vector.front());
+        ASSERT_EQ(unrolled_list[vector.size() - 1], vector.back());
+    }
+
+    const auto &const_list = unrolled_list;
+    for (size_t i = 0; i < vector.size(); ++i) {
+        ASSERT_EQ(const_list[i], vector[i]);
+        ASSERT_EQ(*const_list.iterator_at(i), vector[i]);
+    }
+    ASSERT_TRUE(unrolled_list.iterator_at(vector.size()) == unrolled_list.end());
+}
+
+// Индекс обновляется при вставках и удалениях в середине, делении и слиянии нод, поэтому сверяем его
+// с std::vector на списке из тысяч нод, где он состоит из многих блоков
+TEST(UnrolledLinkedList, indexUpdatedByMidListChanges) {
+    std::vector<int> vector;
+    unrolled_list<int, 3> unrolled_list;
+    for (int i = 0; i < 6000; ++i) {
+        vector.push_back(i);
+        unrolled_list.push_back(i);
+    }
+    ASSERT_EQ(unrolled_list[1234], 1234);
+
+    std::mt19937 gen(3);
+    for (int i = 0; i < 20000; ++i) {
+        size_t pos = gen() % (vector.size() + 1);
+        switch (gen() % 8) {
+            case 0:
+                vector.insert(vector.begin(), i);
+                unrolled_list.push_front(i);
+                break;
+            case 1:
+                vector.push_back(i);
+                unrolled_list.push_back(i);
+                break;
+            case 2:
+            case 3:
+            case 4:
+                vector.insert(vector.begin() + pos, i);
+                unrolled_list.insert(unrolled_list.iterator_at(pos), i);
+                break;
+            case 5:
+                if (pos < vector.size()) {
+                    vector.erase(vector.begin() + pos);
+                    unrolled_list.erase(unrolled_list.iterator_at(pos));
+                }
+                break;
+            case 6:
+                if (!vector.empty()) {
+                    vector.erase(vector.begin());
+                    unrolled_list.pop_front();
+                }
+                break;
+            default:
+                if (!vector.empty()) {
+                    vector.pop_back();
+                    unrolled_list.pop_back();
+                }
+        }
+        if (vector.empty()) {
+            continue;
+        }
+        size_t probe = gen() % vector.size();
+        ASSERT_EQ(unrolled_list[probe], vector[probe]);
+        ASSERT_EQ(*unrolled_list.iterator_at(probe), vector[probe]);
+    }
+    ASSERT_TRUE(std::equal(unrolled_list.begin(), unrolled_list.end(), vector.begin(), vector.end()));
+
+    // Список опустошается и растёт снова, пока индекс действителен
+    while (!vector.empty()) {
+        size_t pos = vector.size() / 2;
+        vector.erase(vector.begin() + pos);
+        unrolled_list.erase(unrolled_list.iterator_at(pos));
+    }
+    ASSERT_TRUE(unrolled_list.empty());
+    for (int i = 0; i < 500; ++i) {
+        vector.insert(vector.begin() + vector.size() / 2, i);
+        unrolled_list.insert(unrolled_list.iterator_at(unrolled_list.size() / 2), i);
+        ASSERT_EQ(unrolled_list[vector.size() / 3], vector[vector.size() / 3]);
+    }
+}
+
+TEST(UnrolledLinkedList, iteratorArithmetic) {
+    std::list<int> std_list;
+    unrolled_list<int, 7> unrolled_list;
+
+    for (int i = 0; i < 300; ++i) {
+        if (i % 4 == 0) {
+            std_list.push_front(i);
+            unrolled_list.push_front(i);
+        } else {
+            std_list.push_back(i);
+            unrolled_list.push_back(i);
+        }
+    }
+    unrolled_list.erase(std::next(unrolled_list.begin(), 100), std::next(unrolled_list.begin(), 120));
+    std_list.erase(std::next(std_list.begin(), 100), std::next(std_list.begin(), 120));
+
+    for (int step: {0, 1, 6, 7, 8, 13, 50, 279, 280}) {
+        auto it = unrolled_list.begin();
+        it += step;
+        if (step == 280) {
+            ASSERT_TRUE(it == unrolled_list.end());
+        } else {
+            ASSERT_EQ(*it, *std::next(std_list.begin(), step));
+        }
+        ASSERT_TRUE(it - step == unrolled_list.begin());
+        ASSERT_TRUE(unrolled_list.end() - (280 - step) == it);
+        ASSERT_EQ(distance(unrolled_list.begin(), it), step);
+        ASSERT_EQ(distance(it, unrolled_list.end()), 280 - step);
+
+        auto advanced = unrolled_list.cbegin();
+        using std::advance;
+        advance(advanced, step);
+        ASSERT_TRUE(advanced == it);
+        ASSERT_TRUE(advanced + (-step) == unrolled_list.cbegin());
+    }
+}
+
+TEST(UnrolledLinkedList, at) {
+    unrolled_list<int> unrolled_list = {1, 2, 3};
+
+    unrolled_list.at(1) = 20;
+
+    ASSERT_EQ(unrolled_list.at(1), 20);
+    ASSERT_THROW(unrolled_list.at(3), std::out_of_range);
+    ASSERT_THROW(std::as_const(unrolled_list).at(100), std::out_of_range);
+}
+
+/*
+    Ноды unrolled_list_auto занимают заданное число байт и выровнены по кэш-линии.
+    При push_back элементы ноды начинаются с первого слота, который идёт сразу после заголовка ноды (три указателя
+    и два size_t), поэтому адрес начала каждого сегмента сдвинут от границы кэш-линии ровно на размер заголовка
+*/
+TEST(UnrolledLinkedList, autoNodeSize) {
+    static_assert(unrolled_list_auto<int, 256>::max_node_size() == (256 - 40) / sizeof(int));
+    static_assert(unrolled_list_auto<double, 4096>::max_node_size() == (4096 - 40) / sizeof(double));
+    static_assert(unrolled_list_auto<std::string>::max_node_size() == (1024 - 40) / sizeof(std::string));
+    static_assert(unrolled_list<int, 7>::max_node_size() == 7);
+
+    unrolled_list_auto<int, 256> list;
+    for (int i = 0; i < 1000; ++i) {
+        list.push_back(i);
+    }
+
+    size_t header = 3 * sizeof(void *) + 2 * sizeof(size_t);
+    for (std::span<int> segment: list.segments()) {
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(segment.data()) % unrolled::cache_line_size, header);
+    }
+
+    for (int i = 0; i < 500; ++i) {
+        list.erase(list.iterator_at((i * 7) % list.size()));
+    }
+    ASSERT_EQ(list.size(), 500);
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+}
+
 TEST(UnrolledLinkedList, clearAndSize) {
     unrolled_list<int> unrolled_list;
     for (int i = 0; i < 100; ++i) {
@@ -194,3 +645,222 @@ TEST(UnrolledLinkedList, AssignFromIterators) {
 //////////////////////////////////////////////////
 
 
+
+/*
+    splice, split и append перевешивают целые ноды между списками; результат сравнивается с std::list::splice
+*/
+TEST(UnrolledLinkedList, spliceAndSplit) {
+    std::list<int> std_list;
+    std::list<int> std_other;
+    unrolled_list<int, 8> unrolled_list;
+    ::unrolled_list<int, 8> other;
+    for (int i = 0; i < 100; ++i) {
+        std_list.push_back(i);
+        unrolled_list.push_back(i);
+        std_other.push_back(1000 + i);
+        other.push_back(1000 + i);
+    }
+
+    std_list.splice(std::next(std_list.begin(), 13), std_other, std::next(std_other.begin(), 5),
+                    std::next(std_other.begin(), 77));
+    unrolled_list.splice(std::next(unrolled_list.begin(), 13), other, std::next(other.begin(), 5),
+                         std::next(other.begin(), 77));
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_THAT(other, ::testing::ElementsAreArray(std_other));
+    ASSERT_EQ(other.size(), 28);
+
+    std_list.splice(std::next(std_list.begin(), 40), std_other, std::next(std_other.begin(), 2),
+                    std::next(std_other.begin(), 4));
+    unrolled_list.splice(std::next(unrolled_list.begin(), 40), other, std::next(other.begin(), 2),
+                         std::next(other.begin(), 4));
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_THAT(other, ::testing::ElementsAreArray(std_other));
+
+    std_list.splice(std::next(std_list.begin(), 3), std_other);
+    unrolled_list.splice(std::next(unrolled_list.begin(), 3), other);
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_TRUE(other.empty());
+    ASSERT_EQ(unrolled_list[150], *std::next(std_list.begin(), 150));
+
+    auto tail = unrolled_list.split(std::next(unrolled_list.begin(), 123));
+    std::list<int> std_tail;
+    std_tail.splice(std_tail.end(), std_list, std::next(std_list.begin(), 123), std_list.end());
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_THAT(tail, ::testing::ElementsAreArray(std_tail));
+
+    unrolled_list.append(std::move(tail));
+    std_list.splice(std_list.end(), std_tail);
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_EQ(unrolled_list.size(), 200);
+    ASSERT_TRUE(tail.empty());
+
+    auto all = unrolled_list.split(unrolled_list.begin());
+    ASSERT_TRUE(unrolled_list.empty());
+    ASSERT_THAT(all, ::testing::ElementsAreArray(std_list));
+}
+
+/*
+    После прореживания списка compact упаковывает элементы в минимальное число полных нод,
+    сохраняя порядок, а stats отражает заполненность до и после
+*/
+TEST(UnrolledLinkedList, compactAndStats) {
+    std::list<std::string> std_list;
+    unrolled_list<std::string, 8> unrolled_list;
+    for (int i = 0; i < 1000; ++i) {
+        std_list.push_back(std::to_string(i));
+        unrolled_list.push_back(std::to_string(i));
+    }
+    ASSERT_EQ(unrolled_list.stats().nodes, 125);
+    ASSERT_EQ(unrolled_list.stats().min_fill, 1.0);
+
+    auto std_it = std_list.begin();
+    auto it = unrolled_list.begin();
+    for (int i = 0; it != unrolled_list.end(); ++i) {
+        if (i % 3 != 0) {
+            std_it = std_list.erase(std_it);
+            it = unrolled_list.erase(it);
+        } else {
+            ++std_it;
+            ++it;
+        }
+    }
+    auto before = unrolled_list.stats();
+    ASSERT_LT(before.average_fill, 1.0);
+    ASSERT_GT(before.wasted_bytes, 0);
+
+    unrolled_list.compact();
+    auto after = unrolled_list.stats();
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_EQ(after.nodes, (std_list.size() + 7) / 8);
+    ASSERT_EQ(after.spare_nodes, before.spare_nodes);
+    ASSERT_EQ(after.wasted_bytes,
+              ((after.nodes * 8 - std_list.size()) * sizeof(std::string) +
+               before.wasted_bytes - (before.nodes * 8 - std_list.size()) * sizeof(std::string)));
+    ASSERT_EQ(unrolled_list[200], *std::next(std_list.begin(), 200));
+
+    unrolled_list.push_front("front");
+    unrolled_list.push_back("back");
+    ASSERT_EQ(unrolled_list.front(), "front");
+    ASSERT_EQ(unrolled_list.back(), "back");
+
+    unrolled_list.clear();
+    unrolled_list.compact();
+    ASSERT_EQ(unrolled_list.stats().nodes, 0);
+    ASSERT_EQ(unrolled_list.stats().average_fill, 1.0);
+}
+
+/*
+    hot_path_counters считает аллокации нод, сдвиги элементов и переходы итераторов между нодами,
+    а политика по умолчанию не увеличивает размер списка
+*/
+TEST(UnrolledLinkedList, hotPathCounters) {
+    static_assert(sizeof(unrolled_list<int, 8>) ==
+                  sizeof(unrolled_list<int, 8, std::allocator<int>, unrolled::no_counters>));
+    ASSERT_EQ((unrolled_list<int, 8>().counter_snapshot().node_allocations), 0);
+
+    unrolled_list<int, 4, std::allocator<int>, unrolled::hot_path_counters> list;
+    for (int i = 0; i < 40; ++i) {
+        list.push_back(i);
+    }
+    unrolled::counter_values values = list.counter_snapshot();
+    ASSERT_EQ(values.node_allocations, 10);
+    ASSERT_EQ(values.peak_nodes, 10);
+    ASSERT_EQ(values.node_frees, 0);
+
+    list.reset_counters();
+    int sum = 0;
+    for (int value: list) {
+        sum += value;
+    }
+    ASSERT_EQ(sum, 780);
+    ASSERT_EQ(list.counter_snapshot().node_walks, 10);
+    ASSERT_EQ(list.counter_snapshot().peak_nodes, 10);
+
+    list.reset_counters();
+    list.insert(std::next(list.begin(), 2), -1);
+    values = list.counter_snapshot();
+    ASSERT_EQ(values.node_allocations, 1);
+    ASSERT_GT(values.elements_shifted, 0);
+
+    list.set_spare_node_limit(0);
+    list.clear();
+    values = list.counter_snapshot();
+    ASSERT_EQ(values.node_frees, 11);
+    ASSERT_EQ(values.peak_nodes, 11);
+}
+
+/*
+    sort сравнивается с std::list::sort (в том числе на устойчивость), merge — с std::list::merge,
+    unique — с std::list::unique. Сортировка переиспользует ноды и выделяет лишь несколько новых
+*/
+TEST(UnrolledLinkedList, sortMergeUnique) {
+    using Pair = std::pair<int, int>;
+    auto by_key = [](const Pair &lhs, const Pair &rhs) { return lhs.first < rhs.first; };
+
+    std::list<Pair> std_list;
+    unrolled_list<Pair, 7, std::allocator<Pair>, unrolled::hot_path_counters> unrolled_list;
+    for (int i = 0; i < 3000; ++i) {
+        Pair value((i * 7919) % 211, i);
+        if (i % 3 == 0) {
+            std_list.push_front(value);
+            unrolled_list.push_front(value);
+        } else {
+            std_list.push_back(value);
+            unrolled_list.push_back(value);
+        }
+    }
+    unrolled_list.reset_counters();
+    std_list.sort(by_key);
+    unrolled_list.sort(by_key);
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_LT(unrolled_list.counter_snapshot().node_allocations, unrolled_list.stats().nodes / 10);
+
+    std::list<Pair> std_other;
+    ::unrolled_list<Pair, 7, std::allocator<Pair>, unrolled::hot_path_counters> other;
+    for (int i = 0; i < 1000; ++i) {
+        std_other.emplace_back(i % 300, -i);
+        other.emplace_back(i % 300, -i);
+    }
+    std_other.sort(by_key);
+    other.sort(by_key);
+    std_list.merge(std_other, by_key);
+    unrolled_list.merge(other, by_key);
+    ASSERT_TRUE(other.empty());
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_EQ(unrolled_list[2500], *std::next(std_list.begin(), 2500));
+
+    auto same_key = [](const Pair &lhs, const Pair &rhs) { return lhs.first == rhs.first; };
+    ASSERT_EQ(unrolled_list.unique(same_key), std_list.unique(same_key));
+    ASSERT_THAT(unrolled_list, ::testing::ElementsAreArray(std_list));
+    ASSERT_EQ(unrolled_list.size(), 300);
+    ASSERT_GE(unrolled_list.stats().average_fill, 0.5);
+
+    ::unrolled_list<std::string, 4> strings{"d", "a", "c", "a", "b", "a"};
+    strings.sort();
+    strings.unique();
+    ASSERT_THAT(strings, ::testing::ElementsAre("a", "b", "c", "d"));
+    strings.merge(::unrolled_list<std::string, 4>{"a", "e"});
+    ASSERT_THAT(strings, ::testing::ElementsAre("a", "a", "b", "c", "d", "e"));
+}
+
+/*
+    Если компаратор бросает исключение посреди сортировки, все элементы остаются в списке
+*/
+TEST(UnrolledLinkedList, sortThrowingComparator) {
+    unrolled_list<int, 5> list;
+    for (int i = 0; i < 500; ++i) {
+        list.push_back((i * 31) % 97);
+    }
+    int calls = 0;
+    ASSERT_THROW(list.sort([&calls](int lhs, int rhs) {
+        if (++calls == 2000) {
+            throw std::runtime_error("comparator");
+        }
+        return lhs < rhs;
+    }), std::runtime_error);
+    ASSERT_EQ(list.size(), 500);
+    ASSERT_EQ(std::distance(list.begin(), list.end()), 500);
+    list.sort();
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+    ASSERT_EQ(list.front(), 0);
+}
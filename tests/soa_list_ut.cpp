@@ -0,0 +1,128 @@
+#include <unrolled_soa_list.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+/*
+    Тесты soa_unrolled_list: вставки и удаления сравниваются с std::vector кортежей,
+    отдельно проверяются колонки (непрерывность и выравнивание) и запись через прокси-ссылки
+*/
+
+using Record = std::tuple<int, double, std::uint8_t>;
+
+template<typename List>
+std::vector<Record> to_vector(const List &list) {
+    std::vector<Record> result;
+    for (auto ref: list) {
+        result.push_back(ref);
+    }
+    return result;
+}
+
+TEST(SoaUnrolledList, matchesVector) {
+    unrolled::basic_soa_unrolled_list<6, std::allocator<Record>, int, double, std::uint8_t> list;
+    std::vector<Record> expected;
+    std::mt19937 gen(11);
+
+    for (int step = 0; step < 3000; ++step) {
+        Record value{step, step * 0.5, static_cast<std::uint8_t>(step)};
+        size_t action = gen() % 6;
+        if (action < 2) {
+            list.push_back(value);
+            expected.push_back(value);
+        } else if (action == 2) {
+            list.push_front(value);
+            expected.insert(expected.begin(), value);
+        } else if (action == 3 || expected.empty()) {
+            size_t pos = expected.empty() ? 0 : gen() % (expected.size() + 1);
+            auto it = list.begin();
+            std::advance(it, pos);
+            ASSERT_EQ(*list.insert(it, value), value);
+            expected.insert(expected.begin() + pos, value);
+        } else {
+            size_t pos = gen() % expected.size();
+            auto it = list.begin();
+            std::advance(it, pos);
+            auto next = list.erase(it);
+            expected.erase(expected.begin() + pos);
+            if (pos < expected.size()) {
+                ASSERT_EQ(*next, expected[pos]);
+            } else {
+                ASSERT_EQ(next, list.end());
+            }
+        }
+        ASSERT_EQ(list.size(), expected.size());
+    }
+    ASSERT_EQ(to_vector(list), expected);
+
+    while (list.size() > 2) {
+        list.pop_back();
+        list.pop_front();
+        expected.pop_back();
+        expected.erase(expected.begin());
+    }
+    ASSERT_EQ(to_vector(list), expected);
+
+    list.pop_back();
+    list.pop_front();
+    ASSERT_TRUE(list.empty());
+    list.pop_back();
+    list.pop_front();
+    ASSERT_TRUE(list.empty());
+    ASSERT_EQ(list.begin(), list.end());
+}
+
+TEST(SoaUnrolledList, columns) {
+    unrolled::soa_unrolled_list<float, std::int64_t> list;
+    for (int i = 0; i < 1000; ++i) {
+        list.emplace_back(static_cast<float>(i), std::int64_t(i) * 3);
+    }
+
+    double sum = 0;
+    size_t nodes = 0;
+    for (std::span<const float> xs: std::as_const(list).column<0>()) {
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(xs.data()) % unrolled::cache_line_size, 0);
+        sum += std::accumulate(xs.begin(), xs.end(), 0.0);
+        ++nodes;
+    }
+    ASSERT_EQ(sum, 999.0 * 1000 / 2);
+    ASSERT_EQ(nodes, (1000 + list.max_node_size() - 1) / list.max_node_size());
+
+    for (std::span<std::int64_t> ys: list.column<1>()) {
+        for (auto &y: ys) {
+            y = -y;
+        }
+    }
+    ASSERT_EQ(std::get<1>(std::tuple<float, std::int64_t>(list.back())), -999 * 3);
+}
+
+TEST(SoaUnrolledList, proxyReferences) {
+    unrolled::soa_unrolled_list<int, double> list{{1, 1.5}, {2, 2.5}, {3, 3.5}};
+
+    for (auto [key, weight]: list) {
+        key *= 10;
+        weight += 1;
+    }
+    ASSERT_EQ(list.front().get<0>(), 10);
+    ASSERT_EQ(list.back().get<1>(), 4.5);
+
+    *list.begin() = *std::prev(list.end());
+    ASSERT_EQ(list.front(), std::make_tuple(30, 4.5));
+    ASSERT_EQ(list.back(), std::make_tuple(30, 4.5));
+
+    auto copy = list;
+    copy.front() = std::make_tuple(7, 0.0);
+    ASSERT_FALSE(copy == list);
+    copy.erase(copy.begin(), copy.end());
+    ASSERT_TRUE(copy.empty());
+
+    auto moved = std::move(list);
+    ASSERT_EQ(moved.size(), 3);
+    ASSERT_TRUE(list.empty());
+}
@@ -0,0 +1,177 @@
+#include <unrolled_sorted_list.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+    Тесты sorted_unrolled_list: сравнение с std::multiset при случайных вставках и удалениях,
+    поиск границ, другой компаратор и строки
+*/
+
+TEST(SortedUnrolledList, matchesMultiset) {
+    unrolled::sorted_unrolled_list<int, 6> list;
+    std::multiset<int> expected;
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> value(0, 200);
+
+    for (int step = 0; step < 5000; ++step) {
+        int v = value(gen);
+        if (gen() % 3 != 0) {
+            auto it = list.insert(v);
+            ASSERT_EQ(*it, v);
+            expected.insert(v);
+        } else {
+            ASSERT_EQ(list.erase(v), expected.erase(v));
+        }
+        ASSERT_EQ(list.size(), expected.size());
+    }
+    ASSERT_TRUE(std::equal(list.begin(), list.end(), expected.begin(), expected.end()));
+
+    for (int v = -1; v <= 201; ++v) {
+        ASSERT_EQ(std::distance(list.begin(), list.lower_bound(v)),
+                  std::distance(expected.begin(), expected.lower_bound(v)));
+        ASSERT_EQ(std::distance(list.begin(), list.upper_bound(v)),
+                  std::distance(expected.begin(), expected.upper_bound(v)));
+        ASSERT_EQ(list.count(v), expected.count(v));
+        ASSERT_EQ(list.contains(v), expected.contains(v));
+    }
+}
+
+TEST(SortedUnrolledList, eraseByIterator) {
+    unrolled::sorted_unrolled_list<int, 4> list;
+    for (int i = 0; i < 100; ++i) {
+        list.insert(i % 10);
+    }
+
+    // Удаляем каждый второй элемент, проходя по списку, чтобы задеть слияния и заимствования нод
+    auto it = list.begin();
+    while (it != list.end()) {
+        it = list.erase(it);
+        if (it != list.end()) {
+            ++it;
+        }
+    }
+    ASSERT_EQ(list.size(), 50);
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(list.count(i), 5);
+    }
+
+    while (!list.empty()) {
+        list.erase(list.find(list.back()));
+    }
+    ASSERT_EQ(list.find(3), list.end());
+    list.insert(3);
+    ASSERT_EQ(*list.find(3), 3);
+}
+
+TEST(SortedUnrolledList, equalElementsKeepInsertionOrder) {
+    struct Entry {
+        int key;
+        int order;
+    };
+    auto by_key = [](const Entry &lhs, const Entry &rhs) { return lhs.key < rhs.key; };
+    unrolled::sorted_unrolled_list<Entry, 5, decltype(by_key)> list(by_key);
+    for (int i = 0; i < 60; ++i) {
+        list.insert(Entry{i % 3, i});
+    }
+
+    auto [first, last] = list.equal_range(Entry{1, 0});
+    std::vector<int> orders;
+    for (; first != last; ++first) {
+        orders.push_back(first->order);
+    }
+    ASSERT_EQ(orders.size(), 20);
+    ASSERT_TRUE(std::is_sorted(orders.begin(), orders.end()));
+}
+
+TEST(SortedUnrolledList, greaterAndStrings) {
+    unrolled::sorted_unrolled_list<int, 4, std::greater<int> > descending{5, 1, 9, 3, 7, 3};
+    ASSERT_THAT(std::vector<int>(descending.begin(), descending.end()), ::testing::ElementsAre(9, 7, 5, 3, 3, 1));
+    ASSERT_EQ(*descending.lower_bound(4), 3);
+    ASSERT_EQ(*descending.upper_bound(9), 7);
+
+    unrolled::sorted_unrolled_list<std::string, 3> words;
+    for (const char *word: {"pear", "apple", "fig", "kiwi", "banana", "cherry", "date", "grape"}) {
+        words.insert(std::string(word));
+    }
+    const auto &view = words;
+    ASSERT_EQ(*view.find(std::string("date")), "date");
+    ASSERT_EQ(view.find(std::string("lemon")), view.end());
+    ASSERT_EQ(view.front(), "apple");
+    ASSERT_EQ(view.back(), "pear");
+
+    auto copy = words;
+    copy.erase(std::string("fig"));
+    ASSERT_FALSE(copy.contains(std::string("fig")));
+    ASSERT_TRUE(words.contains(std::string("fig")));
+
+    auto moved = std::move(copy);
+    moved.insert(std::string("lemon"));
+    ASSERT_EQ(moved.size(), 8);
+    ASSERT_TRUE(std::is_sorted(moved.begin(), moved.end()));
+}
+
+namespace {
+
+struct ThrowingCopy {
+    static inline bool fail = false;
+    int value;
+
+    ThrowingCopy(int v) : value(v) {
+    }
+
+    ThrowingCopy(const ThrowingCopy &other) : value(other.value) {
+        if (fail) {
+            throw std::runtime_error("copy");
+        }
+    }
+
+    ThrowingCopy &operator=(const ThrowingCopy &) = default;
+
+    bool operator<(const ThrowingCopy &other) const { return value < other.value; }
+};
+
+} // namespace
+
+TEST(SortedUnrolledList, failedCopyAssignmentKeepsLookupsWorking) {
+    unrolled::sorted_unrolled_list<ThrowingCopy, 4> list;
+    unrolled::sorted_unrolled_list<ThrowingCopy, 4> other;
+    for (int i = 0; i < 20; ++i) {
+        list.insert(ThrowingCopy(i));
+        other.insert(ThrowingCopy(i * 2));
+    }
+
+    ThrowingCopy::fail = true;
+    ASSERT_THROW(list = other, std::runtime_error);
+    ThrowingCopy::fail = false;
+
+    // Список остался прежним или пустым, но поиск по нему не должен обращаться к освобождённому каталогу
+    if (!list.empty()) {
+        ASSERT_TRUE(list.contains(ThrowingCopy(list.front().value)));
+    }
+    ASSERT_FALSE(list.contains(ThrowingCopy(-1)));
+    list.insert(ThrowingCopy(7));
+    ASSERT_TRUE(list.contains(ThrowingCopy(7)));
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+}
+
+TEST(SortedUnrolledList, insertElementOfTheList) {
+    unrolled::sorted_unrolled_list<std::string, 4> list{"b", "c", "d", "e"};
+    list.insert(*std::next(list.begin(), 3));
+    ASSERT_THAT(std::vector<std::string>(list.begin(), list.end()), ::testing::ElementsAre("b", "c", "d", "e", "e"));
+
+    for (int i = 0; i < 20; ++i) {
+        list.insert(*std::next(list.begin(), i % list.size()));
+    }
+    ASSERT_EQ(list.size(), 25);
+    ASSERT_TRUE(std::is_sorted(list.begin(), list.end()));
+    ASSERT_EQ(list.count(std::string()), 0);
+}
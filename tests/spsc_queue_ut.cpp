@@ -0,0 +1,102 @@
+#include <unrolled_spsc_queue.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Тесты spsc_unrolled_queue: однопоточная проверка порядка, пакетных операций и ограничения числа нод,
+    и прогон с отдельными потоками производителя и потребителя
+*/
+
+TEST(SpscUnrolledQueue, pushAndPop) {
+    unrolled::spsc_unrolled_queue<std::string, 4> queue;
+    ASSERT_TRUE(queue.empty());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.try_push(std::to_string(i)));
+    }
+
+    std::string value;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        ASSERT_EQ(value, std::to_string(i));
+    }
+    ASSERT_FALSE(queue.try_pop(value));
+    ASSERT_TRUE(queue.empty());
+
+    // Оставшиеся в очереди элементы разрушает деструктор
+    queue.try_emplace(3, 'x');
+    queue.try_emplace(5, 'y');
+}
+
+TEST(SpscUnrolledQueue, batchesAndNodeLimit) {
+    unrolled::spsc_unrolled_queue<int, 8> queue(3);
+    std::vector<int> input(30);
+    std::iota(input.begin(), input.end(), 0);
+
+    ASSERT_EQ(queue.try_push_n(input.begin(), input.size()), 24);
+    ASSERT_FALSE(queue.try_push(100));
+
+    std::vector<int> output;
+    ASSERT_EQ(queue.try_pop_n(std::back_inserter(output), 10), 10);
+    ASSERT_EQ(queue.try_push_n(input.begin() + 24, 6), 6);
+    ASSERT_EQ(queue.try_pop_n(std::back_inserter(output), 100), 20);
+    ASSERT_THAT(output, ::testing::ElementsAreArray(input));
+    ASSERT_TRUE(queue.empty());
+
+    // Опустошённые ноды возвращаются производителю, поэтому две ноды из трёх снова доступны после каждого раунда
+    for (int round = 0; round < 100; ++round) {
+        ASSERT_EQ(queue.try_push_n(input.begin(), 16), 16);
+        output.clear();
+        ASSERT_EQ(queue.try_pop_n(std::back_inserter(output), 16), 16);
+        ASSERT_EQ(output.back(), 15);
+    }
+}
+
+TEST(SpscUnrolledQueue, producerAndConsumerThreads) {
+    constexpr int count = 1000000;
+    unrolled::spsc_unrolled_queue<int, 64> queue(16);
+
+    std::thread producer([&] {
+        std::vector<int> batch(100);
+        for (int i = 0; i < count;) {
+            size_t pushed;
+            if (i % 1000 == 0) {
+                std::iota(batch.begin(), batch.end(), i);
+                pushed = queue.try_push_n(batch.begin(), batch.size());
+            } else {
+                pushed = queue.try_push(i) ? 1 : 0;
+            }
+            if (pushed == 0) {
+                // Очередь заполнена: отдаём процессор потребителю, иначе на одном ядре потоки крутятся по кванту
+                std::this_thread::yield();
+            }
+            i += static_cast<int>(pushed);
+        }
+    });
+
+    long long sum = 0;
+    int expected = 0;
+    bool ordered = true;
+    std::vector<int> batch(37);
+    while (expected < count) {
+        size_t popped = queue.try_pop_n(batch.begin(), batch.size());
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < popped; ++i) {
+            ordered = ordered && batch[i] == expected;
+            sum += batch[i];
+            ++expected;
+        }
+    }
+    producer.join();
+
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(sum, static_cast<long long>(count) * (count - 1) / 2);
+    ASSERT_TRUE(queue.empty());
+}